@@ -0,0 +1,214 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+#include <niji/path.hpp>
+#include <niji/support/view.hpp>
+#include <niji/support/bezier.hpp>
+#include <niji/view/flatten.hpp>
+
+// Compares views::flatten, which takes the number of lines for each curve
+// from Wang's formula, with the uniform subdivision of every curve into the
+// same number of lines, which has to be the worst case for the whole path
+// to be within the tolerance. The curves are of mixed scales, like the
+// glyphs & shapes of a page.
+//
+// Usage: flatten [curves] [tolerance]
+
+using niji::dpoint;
+
+// Approximates each curve by `n` lines.
+struct uniform_view : niji::view<uniform_view>
+{
+    template<class Path>
+    using point_type = dpoint;
+
+    unsigned n;
+
+    explicit uniform_view(unsigned n) : n(n) {}
+
+    template<class Sink>
+    struct adaptor
+    {
+        adaptor(Sink& sink, unsigned n) : _sink(sink), _n(n), _prev() {}
+
+        void operator()(niji::move_to_t, dpoint const& pt)
+        {
+            _sink(niji::command::move_to, pt);
+            _prev = pt;
+        }
+
+        void operator()(niji::line_to_t, dpoint const& pt)
+        {
+            _sink(niji::command::line_to, pt);
+            _prev = pt;
+        }
+
+        void operator()(niji::quad_to_t, dpoint const& pt1, dpoint const& pt2)
+        {
+            using namespace niji::bezier;
+            for (unsigned i = 1; i != _n; ++i)
+            {
+                double t = double(i) / _n;
+                _sink(niji::command::line_to, dpoint(
+                    quad_eval(_prev.x, pt1.x, pt2.x, t), quad_eval(_prev.y, pt1.y, pt2.y, t)));
+            }
+            _sink(niji::command::line_to, pt2);
+            _prev = pt2;
+        }
+
+        void operator()(niji::cubic_to_t, dpoint const& pt1, dpoint const& pt2, dpoint const& pt3)
+        {
+            using namespace niji::bezier;
+            for (unsigned i = 1; i != _n; ++i)
+            {
+                double t = double(i) / _n;
+                _sink(niji::command::line_to, dpoint(
+                    cubic_eval(_prev.x, pt1.x, pt2.x, pt3.x, t), cubic_eval(_prev.y, pt1.y, pt2.y, pt3.y, t)));
+            }
+            _sink(niji::command::line_to, pt3);
+            _prev = pt3;
+        }
+
+        template<class Tag>
+        void operator()(Tag tag)
+        {
+            _sink(tag);
+        }
+
+        Sink& _sink;
+        unsigned _n;
+        dpoint _prev;
+    };
+
+    template<class Path, class Sink>
+    void render(Path const& path, Sink& sink) const
+    {
+        niji::render(path, adaptor<Sink>(sink, n));
+    }
+
+    template<class Path, class Sink>
+    void inverse_render(Path const& path, Sink& sink) const
+    {
+        niji::inverse_render(path, adaptor<Sink>(sink, n));
+    }
+};
+
+// Counts the lines, with a checksum so that the work is not elided.
+struct count_sink
+{
+    void operator()(niji::move_to_t, dpoint const& pt)
+    {
+        sum += pt.x;
+    }
+
+    void operator()(niji::line_to_t, dpoint const& pt)
+    {
+        sum += pt.y;
+        ++lines;
+    }
+
+    void operator()(niji::end_tag_t<niji::end_tag::open>) {}
+    void operator()(niji::end_tag_t<niji::end_tag::closed>) {}
+
+    std::size_t lines = 0;
+    double sum = 0;
+};
+
+struct cubic
+{
+    dpoint pts[4];
+
+    dpoint at(double t) const
+    {
+        using niji::bezier::cubic_eval;
+        return dpoint(
+            cubic_eval(pts[0].x, pts[1].x, pts[2].x, pts[3].x, t),
+            cubic_eval(pts[0].y, pts[1].y, pts[2].y, pts[3].y, t));
+    }
+
+    // Max. distance between the curve & `n` uniform lines, sampled within
+    // each span.
+    double error(unsigned n) const
+    {
+        double e = 0;
+        for (unsigned i = 0; i != n; ++i)
+        {
+            dpoint const a = at(double(i) / n), b = at(double(i + 1) / n);
+            for (int j = 1; j != 8; ++j)
+            {
+                double const s = j / 8.0;
+                dpoint const c = at((i + s) / n);
+                e = std::max(e, std::hypot(c.x - (a.x + (b.x - a.x) * s), c.y - (a.y + (b.y - a.y) * s)));
+            }
+        }
+        return e;
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    using namespace niji;
+    using clock = std::chrono::steady_clock;
+
+    int const count = argc > 1 ? std::atoi(argv[1]) : 100000;
+    double const tolerance = argc > 2 ? std::atof(argv[2]) : 0.25;
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> unit(0, 1);
+    std::vector<cubic> curves(count);
+    path<dpoint> p;
+    for (auto& c : curves)
+    {
+        // Scales from 1 to 1000.
+        double const s = std::pow(10.0, 3 * unit(gen));
+        dpoint const o(1000 * unit(gen), 1000 * unit(gen));
+        for (auto& pt : c.pts)
+            pt = dpoint(o.x + s * unit(gen), o.y + s * unit(gen));
+        p.join(c.pts[0]);
+        p.unsafe_cubic_to(c.pts[1], c.pts[2], c.pts[3]);
+        p.cut();
+    }
+
+    // The uniform count that keeps every curve within the tolerance.
+    unsigned n = 1;
+    double wang_error = 0;
+    for (auto const& c : curves)
+    {
+        unsigned const k = bezier::cubic_segments(c.pts[0], c.pts[1], c.pts[2], c.pts[3], tolerance);
+        n = std::max(n, k);
+        wang_error = std::max(wang_error, c.error(k));
+    }
+    double uniform_error = 0;
+    for (auto const& c : curves)
+        uniform_error = std::max(uniform_error, c.error(n));
+
+    auto secs = [](clock::duration d) { return std::chrono::duration<double>(d).count(); };
+    auto run = [&](auto const& view)
+    {
+        count_sink sink;
+        auto const t0 = clock::now();
+        render(p | view, sink);
+        double const t = secs(clock::now() - t0);
+        std::cout << double(sink.lines) / count << " segments/curve, "
+            << count / t * 1e-6 << " Mcurves/s, "
+            << sink.lines / t * 1e-6 << " Mlines/s (" << sink.sum << ")\n";
+    };
+
+    std::cout << count << " cubics, tolerance " << tolerance << "\n"
+        << "wang:    max error " << wang_error << ", ";
+    run(views::flatten<double>(tolerance));
+    std::cout << "uniform: max error " << uniform_error << ", ";
+    run(uniform_view(n));
+    return !(wang_error <= tolerance);
+}
@@ -0,0 +1,217 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <cstdlib>
+#include <iostream>
+#include <initializer_list>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/serialization/split_free.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <niji/path.hpp>
+#include <niji/group.hpp>
+#include <niji/mapped_path.hpp>
+
+// Round-trips a group through the binary records of mapped_path and through
+// Boost.Serialization, checks that both render the same as the original and
+// times the loads. Loading a mapped_group is only the validation of the
+// record, the paths are rendered from the buffer in place.
+//
+// Usage: mapped_path [paths]
+
+// Boost.Serialization doesn't support boost::container.
+namespace boost { namespace serialization
+{
+    template<class Archive, class Container>
+    void save_sequence(Archive& ar, Container const& c)
+    {
+        std::size_t n = c.size();
+        ar << n;
+        for (auto const& e : c)
+            ar << e;
+    }
+
+    template<class Archive, class Container>
+    void load_sequence(Archive& ar, Container& c)
+    {
+        std::size_t n;
+        ar >> n;
+        c.resize(n);
+        for (auto& e : c)
+            ar >> e;
+    }
+
+    template<class Archive, class T, class A>
+    void save(Archive& ar, boost::container::vector<T, A> const& c, unsigned)
+    {
+        save_sequence(ar, c);
+    }
+
+    template<class Archive, class T, class A>
+    void load(Archive& ar, boost::container::vector<T, A>& c, unsigned)
+    {
+        load_sequence(ar, c);
+    }
+
+    template<class Archive, class T, class A>
+    void serialize(Archive& ar, boost::container::vector<T, A>& c, unsigned version)
+    {
+        split_free(ar, c, version);
+    }
+
+    template<class Archive, class T, class A>
+    void save(Archive& ar, boost::container::deque<T, A> const& c, unsigned)
+    {
+        save_sequence(ar, c);
+    }
+
+    template<class Archive, class T, class A>
+    void load(Archive& ar, boost::container::deque<T, A>& c, unsigned)
+    {
+        load_sequence(ar, c);
+    }
+
+    template<class Archive, class T, class A>
+    void serialize(Archive& ar, boost::container::deque<T, A>& c, unsigned version)
+    {
+        split_free(ar, c, version);
+    }
+}}
+
+using niji::dpoint;
+
+// Records the commands & points.
+struct record_sink
+{
+    void operator()(niji::move_to_t, dpoint const& pt)
+    {
+        add(0, {pt});
+    }
+
+    void operator()(niji::line_to_t, dpoint const& pt)
+    {
+        add(1, {pt});
+    }
+
+    void operator()(niji::quad_to_t, dpoint const& pt1, dpoint const& pt2)
+    {
+        add(2, {pt1, pt2});
+    }
+
+    void operator()(niji::cubic_to_t, dpoint const& pt1, dpoint const& pt2, dpoint const& pt3)
+    {
+        add(3, {pt1, pt2, pt3});
+    }
+
+    void operator()(niji::end_tag tag)
+    {
+        data.push_back(4 + tag);
+    }
+
+    void add(int cmd, std::initializer_list<dpoint> pts)
+    {
+        data.push_back(cmd);
+        for (auto const& pt : pts)
+        {
+            data.push_back(pt.x);
+            data.push_back(pt.y);
+        }
+    }
+
+    std::vector<double> data;
+};
+
+int main(int argc, char* argv[])
+{
+    using namespace niji;
+    using clock = std::chrono::steady_clock;
+
+    int const count = argc > 1 ? std::atoi(argv[1]) : 20000;
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> coord(0, 1000);
+    auto pt = [&] { return dpoint(coord(gen), coord(gen)); };
+    group<path<dpoint>> g;
+    for (int k = 0; k != count; ++k)
+    {
+        path<dpoint> p;
+        for (int f = 0; f != 2; ++f)
+        {
+            p.join(pt());
+            for (int i = 0; i != 10; ++i)
+            {
+                switch (gen() % 3)
+                {
+                case 0:
+                    p.join(pt());
+                    break;
+                case 1:
+                {
+                    auto const p1 = pt();
+                    p.unsafe_quad_to(p1, pt());
+                    break;
+                }
+                default:
+                {
+                    auto const p1 = pt(), p2 = pt();
+                    p.unsafe_cubic_to(p1, p2, pt());
+                }
+                }
+            }
+            if (f)
+                p.close();
+            else
+                p.cut();
+        }
+        g.add(std::move(p));
+    }
+
+    auto const t0 = clock::now();
+    std::vector<char> buf;
+    write_binary<double>(g, buf);
+    auto const t1 = clock::now();
+    std::string archive;
+    {
+        std::ostringstream os;
+        boost::archive::binary_oarchive oa(os);
+        oa << g;
+        archive = os.str();
+    }
+    auto const t2 = clock::now();
+    mapped_group<double> const mapped(buf.data(), buf.size());
+    auto const t3 = clock::now();
+    group<path<dpoint>> loaded;
+    {
+        boost::iostreams::stream<boost::iostreams::array_source> is(archive.data(), archive.size());
+        boost::archive::binary_iarchive ia(is);
+        ia >> loaded;
+    }
+    auto const t4 = clock::now();
+
+    record_sink original, from_mapped, from_archive;
+    render(g, original);
+    auto const t5 = clock::now();
+    render(mapped, from_mapped);
+    auto const t6 = clock::now();
+    render(loaded, from_archive);
+    auto const t7 = clock::now();
+    bool const same = original.data == from_mapped.data && original.data == from_archive.data;
+
+    auto ms = [](clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+    std::cout << count << " paths, " << (same ? "round-trips match" : "round-trips MISMATCH") << "\n"
+        << "mapped_path:   " << buf.size() << " bytes, save " << ms(t1 - t0)
+        << " ms, load " << ms(t3 - t2) << " ms, render " << ms(t6 - t5) << " ms\n"
+        << "serialization: " << archive.size() << " bytes, save " << ms(t2 - t1)
+        << " ms, load " << ms(t4 - t3) << " ms, render " << ms(t7 - t6) << " ms\n";
+    return !same;
+}
@@ -0,0 +1,110 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+
+#include <cstring>
+#include <iostream>
+#include <niji/path.hpp>
+#include <niji/algorithm/boolean.hpp>
+#include <niji/algorithm/contains.hpp>
+#include <niji/graphic/svg_path.hpp>
+
+// Checks the boolean operations against the point tests of the operands on a
+// grid, the samples by the boundaries are skipped.
+//
+// The pair used to lose the crossings of the consecutive cubics of b, which
+// leave their common end at a sharp angle.
+int main()
+{
+    using namespace niji;
+    using path_t = path<dpoint>;
+
+    auto parse = [](char const* s)
+    {
+        path_t p;
+        path_t::sink sink(p);
+        parse_svg_path<double>(s, s + std::strlen(s), sink);
+        return p;
+    };
+
+    path_t const a = parse(
+        "M 120.2524 17.9728 Q 11.8651 71.0660 119.5431 50.3155 "
+        "C 8.6749 109.3492 86.6897 120.3907 79.4467 16.3298 "
+        "Q 110.8232 87.0630 122.6256 65.3666 "
+        "C 21.2683 71.6900 76.9182 85.2506 68.6529 70.6613 L 23.5938 5.7135 Z "
+        "M 62.9046 95.1688 L 35.9778 86.5386 Q 99.4135 28.5071 42.6990 106.0834 Z");
+    path_t const b = parse(
+        "M 92.8144 15.3939 C 47.1450 30.8914 107.5019 20.1419 50.9754 30.5205 "
+        "C 115.1861 32.0931 78.1211 14.8821 112.8657 25.0613 "
+        "C 60.4611 9.8898 26.8913 11.7026 95.0026 103.7332 Z");
+
+    auto winding = [](path_t const& p, dpoint pt)
+    {
+        detail::contains_sink<double> test{pt};
+        render(p, test);
+        return test.winding;
+    };
+
+    char const* names[] = {"union", "intersection", "difference", "xor"};
+    int failed = 0;
+    for (fill_rule rule : {fill_rule::nonzero, fill_rule::evenodd})
+    {
+        auto inside = [&](path_t const& p, dpoint pt)
+        {
+            int const w = winding(p, pt);
+            return rule == fill_rule::nonzero ? w != 0 : (w & 1) != 0;
+        };
+        for (int op = 0; op != 4; ++op)
+        {
+            auto expect = [&](dpoint pt)
+            {
+                bool const in_a = inside(a, pt), in_b = inside(b, pt);
+                switch (op)
+                {
+                case 0: return in_a || in_b;
+                case 1: return in_a && in_b;
+                case 2: return in_a && !in_b;
+                default: return in_a != in_b;
+                }
+            };
+            path_t result;
+            path_t::sink sink(result);
+            switch (op)
+            {
+            case 0: path_union(a, b, sink, rule); break;
+            case 1: path_intersection(a, b, sink, rule); break;
+            case 2: path_difference(a, b, sink, rule); break;
+            default: path_xor(a, b, sink, rule);
+            }
+            int bad = 0;
+            for (double y = 0.5; y < 130; ++y)
+            {
+                for (double x = 0.5; x < 130; ++x)
+                {
+                    dpoint const pt(x, y);
+                    bool const e = expect(pt);
+                    if (e == (winding(result, pt) != 0))
+                        continue;
+                    bool edge = false;
+                    for (double d : {-0.01, 0.01})
+                    {
+                        edge = edge || expect(dpoint(x + d, y)) != e
+                            || expect(dpoint(x, y + d)) != e;
+                    }
+                    if (!edge)
+                        ++bad;
+                }
+            }
+            if (bad)
+            {
+                std::cout << names[op] << (rule == fill_rule::nonzero ? " (nonzero)" : " (evenodd)")
+                    << ": " << bad << " wrong samples\n";
+                ++failed;
+            }
+        }
+    }
+    return failed;
+}
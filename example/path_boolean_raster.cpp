@@ -0,0 +1,199 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <niji/path.hpp>
+#include <niji/algorithm/boolean.hpp>
+#include <niji/algorithm/contains.hpp>
+#include <niji/graphic/svg_path.hpp>
+#include <niji/sink/raster.hpp>
+
+// Rasterizes the results of the boolean operations on self-intersecting
+// operands and compares them with the masks of the operands. Unlike the
+// point tests, the coverage also catches the hairline slivers, e.g. a chord
+// closing a broken chain of the result.
+//
+// The checked pixels are those where both operands are uniform over the
+// 3x3 neighborhood. Under nonzero, the coverage of the operands saturates
+// where the winding is beyond 1, so each mismatch is confirmed by the point
+// tests on a sub-grid of the pixel.
+
+using path_t = niji::path<niji::dpoint>;
+
+constexpr unsigned size = 128;
+
+std::vector<std::uint8_t> mask(path_t const& p, niji::fill_rule rule)
+{
+    std::vector<std::uint8_t> m(size * size);
+    niji::raster_sink<double> sink(m.data(), size, size, size, rule, 0.01);
+    niji::render(p, sink);
+    sink.flush();
+    return m;
+}
+
+bool inside(path_t const& p, niji::dpoint const& pt, niji::fill_rule rule)
+{
+    niji::detail::contains_sink<double> test{pt};
+    niji::render(p, test);
+    return rule == niji::fill_rule::nonzero ? test.winding != 0 : (test.winding & 1) != 0;
+}
+
+bool apply(int op, bool a, bool b)
+{
+    switch (op)
+    {
+    case 0: return a || b;
+    case 1: return a && b;
+    case 2: return a && !b;
+    default: return a != b;
+    }
+}
+
+path_t combine(int op, path_t const& a, path_t const& b, niji::fill_rule rule)
+{
+    path_t result;
+    path_t::sink sink(result);
+    switch (op)
+    {
+    case 0: niji::path_union(a, b, sink, rule); break;
+    case 1: niji::path_intersection(a, b, sink, rule); break;
+    case 2: niji::path_difference(a, b, sink, rule); break;
+    default: niji::path_xor(a, b, sink, rule);
+    }
+    return result;
+}
+
+// Returns the number of the wrong pixels.
+int check(path_t const& a, path_t const& b, int op, niji::fill_rule rule)
+{
+    auto const ma = mask(a, rule), mb = mask(b, rule);
+    // The result has winding 1 inside.
+    auto const mr = mask(combine(op, a, b, rule), niji::fill_rule::nonzero);
+    int bad = 0;
+    for (unsigned y = 1; y + 1 < size; ++y)
+    {
+        for (unsigned x = 1; x + 1 < size; ++x)
+        {
+            unsigned const i = y * size + x;
+            if ((ma[i] != 0 && ma[i] != 255) || (mb[i] != 0 && mb[i] != 255))
+                continue;
+            bool uniform = true;
+            for (unsigned j : {i - size - 1, i - size, i - size + 1, i - 1, i + 1, i + size - 1, i + size, i + size + 1})
+                uniform = uniform && ma[j] == ma[i] && mb[j] == mb[i];
+            if (!uniform)
+                continue;
+            int const expected = apply(op, ma[i] != 0, mb[i] != 0) ? 255 : 0;
+            if (std::abs(mr[i] - expected) <= 32)
+                continue;
+            int covered = 0;
+            for (int sy = 0; sy != 8; ++sy)
+            {
+                for (int sx = 0; sx != 8; ++sx)
+                {
+                    niji::dpoint const pt(x + (sx + 0.5) / 8, y + (sy + 0.5) / 8);
+                    covered += apply(op, inside(a, pt, rule), inside(b, pt, rule));
+                }
+            }
+            if (std::abs(mr[i] - covered * 255 / 64) > 32)
+                ++bad;
+        }
+    }
+    return bad;
+}
+
+// Closed figures of random lines & curves.
+path_t random_path(std::mt19937& gen)
+{
+    std::uniform_real_distribution<double> coord(0, 120);
+    auto pt = [&] { return niji::dpoint(coord(gen), coord(gen)); };
+    path_t p;
+    for (int k = 0, figures = 2 + gen() % 4; k != figures; ++k)
+    {
+        p.join(pt());
+        for (int i = 0, n = 2 + gen() % 4; i != n; ++i)
+        {
+            switch (gen() % 3)
+            {
+            case 0:
+                p.join(pt());
+                break;
+            case 1:
+            {
+                auto const p1 = pt();
+                p.unsafe_quad_to(p1, pt());
+                break;
+            }
+            default:
+            {
+                auto const p1 = pt(), p2 = pt();
+                p.unsafe_cubic_to(p1, p2, pt());
+            }
+            }
+        }
+        p.close();
+    }
+    return p;
+}
+
+int main(int argc, char* argv[])
+{
+    using namespace niji;
+
+    char const* names[] = {"union", "intersection", "difference", "xor"};
+    int failed = 0;
+    auto report = [&](char const* what, int op, fill_rule rule, int bad)
+    {
+        if (!bad)
+            return;
+        std::cout << what << ", " << names[op] << (rule == fill_rule::nonzero ? " (nonzero)" : " (evenodd)")
+            << ": " << bad << " wrong pixels\n";
+        ++failed;
+    };
+
+    // The consecutive cubics of the second figure run back close to each
+    // other, their crossing used to be lost, which left a sliver.
+    char const s[] =
+        "M 43.880385081972115 22.122572265264104 L 22.306794514419067 13.576809297053428 "
+        "Q 93.132830919249997 13.210882010844108 84.638290092711671 81.840753650380535 Z "
+        "M 9.0807577095566092 16.392886180278772 L 10.206158166925572 77.297886337258348 "
+        "C 46.3985946448947 103.83325561696755 6.437353006001338 6.1636720835359977 119.9586500204708 81.640596386292671 "
+        "C 55.591177711599457 40.600778621453387 67.7922392306387 52.929587441178271 0.017814405116532084 112.82223096652481 Z";
+    path_t crossed;
+    path_t::sink sink(crossed);
+    parse_svg_path<double>(s, s + std::strlen(s), sink);
+    path_t const empty;
+    for (fill_rule rule : {fill_rule::nonzero, fill_rule::evenodd})
+    {
+        for (int op = 0; op != 4; ++op)
+            report("crossed", op, rule, check(crossed, empty, op, rule));
+    }
+
+    int const pairs = argc > 1 ? std::atoi(argv[1]) : 200;
+    for (int seed = 0; seed != pairs; ++seed)
+    {
+        std::mt19937 gen(seed);
+        path_t const a = random_path(gen), b = random_path(gen);
+        for (fill_rule rule : {fill_rule::nonzero, fill_rule::evenodd})
+        {
+            for (int op = 0; op != 4; ++op)
+            {
+                if (int bad = check(a, b, op, rule))
+                {
+                    std::cout << "seed " << seed << ", ";
+                    report("random", op, rule, bad);
+                }
+            }
+        }
+    }
+    return failed;
+}
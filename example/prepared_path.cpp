@@ -0,0 +1,93 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstdlib>
+#include <iostream>
+#include <niji/path.hpp>
+#include <niji/prepared_path.hpp>
+#include <niji/algorithm/contains.hpp>
+
+// Times the point tests of prepared_path against the linear niji::contains,
+// on a path of many small figures (e.g. a map or a page of glyphs), and
+// checks that they agree.
+//
+// Usage: prepared_path [figures] [queries]
+int main(int argc, char* argv[])
+{
+    using namespace niji;
+    using clock = std::chrono::steady_clock;
+
+    int const figures = argc > 1 ? std::atoi(argv[1]) : 2000;
+    int const queries = argc > 2 ? std::atoi(argv[2]) : 20000;
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> coord(0, 1000), unit(0, 1);
+    path<dpoint> p;
+    for (int k = 0; k != figures; ++k)
+    {
+        dpoint const c(coord(gen), coord(gen));
+        double const r = 2 + 8 * unit(gen);
+        int const n = 3 + gen() % 5;
+        auto at = [&](double a, double s)
+        {
+            return dpoint(c.x + s * r * std::cos(a), c.y + s * r * std::sin(a));
+        };
+        p.join(at(0, 1));
+        for (int i = 1; i <= n; ++i)
+        {
+            double const a = i * 6.283185307179586 / n, h = 3.141592653589793 / n;
+            switch (gen() % 3)
+            {
+            case 0:
+                p.join(at(a, 1));
+                break;
+            case 1:
+                p.unsafe_quad_to(at(a - h, 1.5), at(a, 1));
+                break;
+            default:
+                p.unsafe_cubic_to(at(a - 1.5 * h, 1.3), at(a - 0.5 * h, 0.6), at(a, 1));
+            }
+        }
+        p.close();
+    }
+
+    std::vector<dpoint> pts(queries);
+    for (auto& pt : pts)
+        pt = dpoint(coord(gen), coord(gen));
+
+    auto const t0 = clock::now();
+    prepared_path<double> const prepared(p);
+    auto const t1 = clock::now();
+    std::vector<char> linear(queries), indexed(queries);
+    for (int i = 0; i != queries; ++i)
+        linear[i] = contains(p, pts[i]);
+    auto const t2 = clock::now();
+    for (int i = 0; i != queries; ++i)
+        indexed[i] = prepared.contains(pts[i]);
+    auto const t3 = clock::now();
+
+    auto secs = [](clock::duration d) { return std::chrono::duration<double>(d).count(); };
+    int mismatches = 0, inside = 0;
+    for (int i = 0; i != queries; ++i)
+    {
+        mismatches += linear[i] != indexed[i];
+        inside += linear[i];
+    }
+    std::cout << figures << " figures, " << prepared.size() << " monotonic segments, "
+        << queries << " queries (" << inside << " inside)\n"
+        << "prepare:  " << secs(t1 - t0) * 1e3 << " ms\n"
+        << "linear:   " << queries / secs(t2 - t1) << " queries/s\n"
+        << "prepared: " << queries / secs(t3 - t2) << " queries/s ("
+        << secs(t2 - t1) / secs(t3 - t2) << "x)\n";
+    if (mismatches)
+        std::cout << mismatches << " mismatches\n";
+    return mismatches != 0;
+}
@@ -0,0 +1,112 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+#include <niji/path.hpp>
+#include <niji/sink/raster.hpp>
+
+// Measures raster_sink on a full canvas of large overlapping figures
+// (Mpix/s) and on many glyph-sized masks (paths/s), under both fill rules.
+// Build with NIJI_NO_SIMD defined to compare with the scalar code.
+//
+// Usage: raster [frames] [glyphs]
+
+using path_t = niji::path<niji::point<float>>;
+
+// Closed figures of random lines & curves within [0, size)^2.
+path_t random_path(std::mt19937& gen, float size, int figures, int segments)
+{
+    std::uniform_real_distribution<float> coord(0, size);
+    auto pt = [&] { return niji::point<float>(coord(gen), coord(gen)); };
+    path_t p;
+    for (int k = 0; k != figures; ++k)
+    {
+        p.join(pt());
+        for (int i = 0; i != segments; ++i)
+        {
+            switch (gen() % 3)
+            {
+            case 0:
+                p.join(pt());
+                break;
+            case 1:
+            {
+                auto const p1 = pt();
+                p.unsafe_quad_to(p1, pt());
+                break;
+            }
+            default:
+            {
+                auto const p1 = pt(), p2 = pt();
+                p.unsafe_cubic_to(p1, p2, pt());
+            }
+            }
+        }
+        p.close();
+    }
+    return p;
+}
+
+int main(int argc, char* argv[])
+{
+    using namespace niji;
+    using clock = std::chrono::steady_clock;
+
+    int const frames = argc > 1 ? std::atoi(argv[1]) : 50;
+    int const glyphs = argc > 2 ? std::atoi(argv[2]) : 20000;
+    unsigned const canvas = 1024, glyph = 32;
+
+    std::mt19937 gen(42);
+    path_t const scene = random_path(gen, float(canvas), 20, 8);
+    std::vector<path_t> small;
+    small.reserve(glyphs);
+    for (int i = 0; i != glyphs; ++i)
+        small.push_back(random_path(gen, float(glyph), 2, 6));
+
+    auto secs = [](clock::duration d) { return std::chrono::duration<double>(d).count(); };
+    std::vector<std::uint8_t> data(canvas * canvas);
+    unsigned checksum = 0;
+    for (fill_rule rule : {fill_rule::nonzero, fill_rule::evenodd})
+    {
+        char const* name = rule == fill_rule::nonzero ? "nonzero" : "evenodd";
+
+        raster_sink<float> sink(data.data(), canvas, canvas, canvas, rule);
+        auto const t0 = clock::now();
+        for (int i = 0; i != frames; ++i)
+        {
+            render(scene, sink);
+            sink.flush();
+        }
+        double const t = secs(clock::now() - t0);
+        for (auto c : data)
+            checksum += c;
+        std::cout << name << ", " << canvas << "x" << canvas << " scene: "
+            << double(canvas) * canvas * frames / t * 1e-6 << " Mpix/s, "
+            << frames / t << " frames/s\n";
+
+        raster_sink<float> glyph_sink(data.data(), glyph, glyph, glyph, rule);
+        auto const t1 = clock::now();
+        for (auto const& p : small)
+        {
+            std::fill_n(data.data(), glyph * glyph, 0);
+            render(p, glyph_sink);
+            glyph_sink.flush();
+            checksum += data[glyph * glyph / 2];
+        }
+        double const u = secs(clock::now() - t1);
+        std::cout << name << ", " << glyph << "x" << glyph << " glyphs: "
+            << double(glyph) * glyph * glyphs / u * 1e-6 << " Mpix/s, "
+            << glyphs / u << " paths/s\n";
+    }
+    std::cout << "checksum " << checksum << "\n";
+}
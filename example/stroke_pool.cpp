@@ -0,0 +1,148 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+
+#include <new>
+#include <array>
+#include <random>
+#include <vector>
+#include <cstdlib>
+#include <cstddef>
+#include <iostream>
+#include <memory_resource>
+#include <niji/path.hpp>
+#include <niji/support/command.hpp>
+#include <niji/view/stroke.hpp>
+#include <niji/view/offset.hpp>
+#include <niji/view/dash.hpp>
+
+// Strokes, offsets & dashes many short polylines per frame with the scratch
+// paths from a pool, and checks that once warmed, the frames make no heap
+// allocations at all: neither the pool asks its upstream for more, nor does
+// anything else call operator new.
+
+static std::size_t new_count = 0;
+
+void* operator new(std::size_t n)
+{
+    ++new_count;
+    if (void* p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+// Counts what the pool takes from the heap.
+struct counting_resource : std::pmr::memory_resource
+{
+    std::size_t count = 0;
+
+private:
+
+    void* do_allocate(std::size_t bytes, std::size_t align) override
+    {
+        ++count;
+        return std::pmr::new_delete_resource()->allocate(bytes, align);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t align) override
+    {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+    }
+
+    bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+// Keeps the output from being optimized out.
+struct sum_sink
+{
+    double sum = 0;
+
+    void operator()(niji::move_to_t, niji::dpoint const& pt)
+    {
+        sum += pt.x;
+    }
+
+    void operator()(niji::line_to_t, niji::dpoint const& pt)
+    {
+        sum += pt.x;
+    }
+
+    void operator()(niji::quad_to_t, niji::dpoint const& pt1, niji::dpoint const& pt2)
+    {
+        sum += pt1.x + pt2.x;
+    }
+
+    void operator()(niji::cubic_to_t, niji::dpoint const& pt1, niji::dpoint const& pt2, niji::dpoint const& pt3)
+    {
+        sum += pt1.x + pt2.x + pt3.x;
+    }
+
+    template<niji::end_tag E>
+    void operator()(niji::end_tag_t<E>) {}
+};
+
+int main()
+{
+    using namespace niji;
+    using alloc_t = std::pmr::polymorphic_allocator<dpoint>;
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> coord(0, 500);
+    std::vector<path<dpoint>> lines(2000);
+    for (auto& line : lines)
+    {
+        for (int i = 0, n = 2 + gen() % 6; i != n; ++i)
+            line.join(dpoint(coord(gen), coord(gen)));
+        if (gen() % 2)
+            line.close();
+    }
+
+    counting_resource heap;
+    std::pmr::unsynchronized_pool_resource pool(&heap);
+    alloc_t alloc(&pool);
+    std::array<double, 2> const pattern{{8, 4}};
+
+    // The styles are picked at runtime, as from a style sheet.
+    auto stroke = views::stroke<double>(2,
+        join_style<double>(join_styles::miter<double>(4)), cap_style<double>(cap_styles::round{}), alloc);
+    auto offset = views::offset<double>(1.5, join_styles::variant<double>(join_styles::bevel{}), alloc);
+    auto dash = views::dash<double>(pattern, 0.0, 1.0, alloc);
+
+    sum_sink sink;
+    auto frame = [&]
+    {
+        for (auto const& line : lines)
+        {
+            render(line | stroke, sink);
+            render(line | offset, sink);
+            render(line | dash | stroke, sink);
+        }
+    };
+
+    std::size_t const setup_new = new_count;
+    frame();
+    std::size_t const warm_heap = heap.count, warm_new = new_count;
+    for (int i = 0; i != 10; ++i)
+        frame();
+    std::size_t const heap_allocs = heap.count - warm_heap, new_allocs = new_count - warm_new;
+
+    std::cout << "warm-up: " << warm_heap << " pool refills, " << warm_new - setup_new << " operator new\n"
+        << "10 frames: " << heap_allocs << " pool refills, " << new_allocs << " operator new\n";
+    return heap_allocs || new_allocs;
+}
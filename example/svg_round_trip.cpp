@@ -0,0 +1,176 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+#include <initializer_list>
+#include <niji/path.hpp>
+#include <niji/sink/svg.hpp>
+#include <niji/graphic/svg_path.hpp>
+
+// Writes a path as SVG path data with basic_svg_writer in several formats,
+// parses it back with parse_svg_path, and reports the sizes, the throughput
+// of both ways and the max. error of the round-trip.
+//
+// Usage: svg_round_trip [figures]
+
+using niji::dpoint;
+
+// Records the commands & points, the open ends are implied by the moves.
+struct record_sink
+{
+    void operator()(niji::move_to_t, dpoint const& pt)
+    {
+        add(0, {pt});
+    }
+
+    void operator()(niji::line_to_t, dpoint const& pt)
+    {
+        add(1, {pt});
+    }
+
+    void operator()(niji::quad_to_t, dpoint const& pt1, dpoint const& pt2)
+    {
+        add(2, {pt1, pt2});
+    }
+
+    void operator()(niji::cubic_to_t, dpoint const& pt1, dpoint const& pt2, dpoint const& pt3)
+    {
+        add(3, {pt1, pt2, pt3});
+    }
+
+    void operator()(niji::end_open_t) {}
+
+    void operator()(niji::end_closed_t)
+    {
+        cmds.push_back(4);
+    }
+
+    void add(char cmd, std::initializer_list<dpoint> pts)
+    {
+        cmds.push_back(cmd);
+        for (auto const& pt : pts)
+        {
+            coords.push_back(pt.x);
+            coords.push_back(pt.y);
+        }
+    }
+
+    // The max. difference of the coordinates, or infinity if the commands
+    // differ.
+    double error(record_sink const& other) const
+    {
+        if (cmds != other.cmds || coords.size() != other.coords.size())
+            return INFINITY;
+        double e = 0;
+        for (std::size_t i = 0; i != coords.size(); ++i)
+            e = std::max(e, std::abs(coords[i] - other.coords[i]));
+        return e;
+    }
+
+    std::vector<char> cmds;
+    std::vector<double> coords;
+};
+
+int main(int argc, char* argv[])
+{
+    using namespace niji;
+    using clock = std::chrono::steady_clock;
+
+    int const figures = argc > 1 ? std::atoi(argv[1]) : 20000;
+
+    // Figures of lines & curves, some axis-aligned, at the scale of a page.
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> coord(0, 1000);
+    auto pt = [&] { return dpoint(coord(gen), coord(gen)); };
+    path<dpoint> p;
+    for (int k = 0; k != figures; ++k)
+    {
+        dpoint last = pt();
+        p.join(last);
+        for (int i = 0; i != 8; ++i)
+        {
+            switch (gen() % 4)
+            {
+            case 0:
+                last = gen() % 2 ? dpoint(coord(gen), last.y) : dpoint(last.x, coord(gen));
+                p.join(last);
+                break;
+            case 1:
+                p.join(last = pt());
+                break;
+            case 2:
+            {
+                auto const p1 = pt();
+                p.unsafe_quad_to(p1, last = pt());
+                break;
+            }
+            default:
+            {
+                auto const p1 = pt(), p2 = pt();
+                p.unsafe_cubic_to(p1, p2, last = pt());
+            }
+            }
+        }
+        if (k % 2)
+            p.close();
+        else
+            p.cut();
+    }
+
+    record_sink original;
+    render(p, original);
+
+    // The relative commands are summed by the reader, which may differ in
+    // the last bits.
+    struct
+    {
+        char const* name;
+        svg_format fmt;
+        double tolerance;
+    } const formats[] =
+    {
+        {"shortest", {}, 0},
+        {"shortest, relative, compact", {-1, true, true}, 1e-9},
+        {"precision 3", {3}, 0.5e-3 + 1e-9},
+        {"precision 3, relative, compact", {3, true, true}, 0.5e-3 + 1e-9}
+    };
+
+    auto secs = [](clock::duration d) { return std::chrono::duration<double>(d).count(); };
+    // At most a letter & 2 numbers of 48 chars with the separators for each
+    // point, and a 'Z' for each figure.
+    std::vector<char> buf(p.size() * 100 + figures);
+    int failed = 0;
+    for (auto const& f : formats)
+    {
+        auto const t0 = clock::now();
+        basic_svg_writer<char*> writer(buf.data(), f.fmt);
+        render(p, writer);
+        auto const t1 = clock::now();
+        char const* const end = writer.out();
+        record_sink parsed;
+        parsed.cmds.reserve(original.cmds.size());
+        parsed.coords.reserve(original.coords.size());
+        auto const t2 = clock::now();
+        bool const complete = parse_svg_path<double>(buf.data(), end, parsed) == end;
+        auto const t3 = clock::now();
+        double const error = complete ? original.error(parsed) : INFINITY;
+        bool const ok = error <= f.tolerance;
+        failed += !ok;
+        std::size_t const size = end - buf.data();
+        std::cout << f.name << ": " << size << " bytes, write "
+            << size / secs(t1 - t0) * 1e-6 << " MB/s, parse "
+            << size / secs(t3 - t2) * 1e-6 << " MB/s, max. error " << error
+            << (ok ? "\n" : " FAILED\n");
+    }
+    return failed;
+}
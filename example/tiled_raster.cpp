@@ -0,0 +1,129 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+#include <niji/path.hpp>
+#include <niji/sink/raster.hpp>
+#include <niji/sink/tiled_raster.hpp>
+
+// Measures the scaling of tiled_rasterizer over the number of workers, on a
+// page of small & large figures, against raster_sink on a single thread.
+// The masks are compared with that of raster_sink as well, they differ on
+// the curves within the flattening tolerance, as the tiled rasterizer
+// flattens the pieces chopped at the y-extrema.
+//
+// Usage: tiled_raster [frames] [max. workers]
+
+using path_t = niji::path<niji::point<float>>;
+
+void add_figure(path_t& p, std::mt19937& gen, float x, float y, float size, int segments)
+{
+    std::uniform_real_distribution<float> coord(0, size);
+    auto pt = [&] { return niji::point<float>(x + coord(gen), y + coord(gen)); };
+    p.join(pt());
+    for (int i = 0; i != segments; ++i)
+    {
+        switch (gen() % 3)
+        {
+        case 0:
+            p.join(pt());
+            break;
+        case 1:
+        {
+            auto const p1 = pt();
+            p.unsafe_quad_to(p1, pt());
+            break;
+        }
+        default:
+        {
+            auto const p1 = pt(), p2 = pt();
+            p.unsafe_cubic_to(p1, p2, pt());
+        }
+        }
+    }
+    p.close();
+}
+
+int main(int argc, char* argv[])
+{
+    using namespace niji;
+    using clock = std::chrono::steady_clock;
+
+    int const frames = argc > 1 ? std::atoi(argv[1]) : 10;
+    unsigned const workers = argc > 2 ? unsigned(std::atoi(argv[2])) :
+        std::max(std::thread::hardware_concurrency(), 1u);
+    unsigned const size = 2048;
+
+    // Lines of glyphs, with a few large shapes over them.
+    std::mt19937 gen(42);
+    path_t page;
+    for (unsigned y = 8; y + 24 < size; y += 32)
+    {
+        for (unsigned x = 8; x + 24 < size; x += 20)
+            add_figure(page, gen, float(x), float(y), 16, 4);
+    }
+    for (int i = 0; i != 16; ++i)
+        add_figure(page, gen, 0, 0, float(size), 6);
+
+    auto secs = [](clock::duration d) { return std::chrono::duration<double>(d).count(); };
+    double const pixels = double(size) * size * frames;
+
+    std::vector<std::uint8_t> expected(size * size);
+    raster_sink<float> sink(expected.data(), size, size, size);
+    auto const t0 = clock::now();
+    for (int i = 0; i != frames; ++i)
+    {
+        render(page, sink);
+        sink.flush();
+    }
+    double const base = secs(clock::now() - t0);
+    std::cout << size << "x" << size << ", " << page.size() << " points, "
+        << std::thread::hardware_concurrency() << " hardware threads\n"
+        << "raster_sink:    " << base / frames * 1e3 << " ms/frame, "
+        << pixels / base * 1e-6 << " Mpix/s\n";
+
+    std::vector<std::uint8_t> data(size * size);
+    tiled_rasterizer<float> tiled(data.data(), size, size, size);
+    int maxdiff = 0;
+    double sumdiff = 0, single = 0;
+    int runs = 0;
+    for (unsigned n = 1; ; n = std::min(n * 2, workers))
+    {
+        auto const t1 = clock::now();
+        for (int i = 0; i != frames; ++i)
+        {
+            render(page, tiled);
+            detail::thread_executor executor;
+            tiled.flush(executor, n);
+        }
+        double const t = secs(clock::now() - t1);
+        if (n == 1)
+            single = t;
+        ++runs;
+        for (std::size_t i = 0; i != data.size(); ++i)
+        {
+            int const d = std::abs(data[i] - expected[i]);
+            maxdiff = std::max(maxdiff, d);
+            sumdiff += d;
+        }
+        std::cout << "tiled, " << n << (n == 1 ? " worker:  " : " workers: ")
+            << t / frames * 1e3 << " ms/frame, " << pixels / t * 1e-6 << " Mpix/s, "
+            << single / t << "x of 1 worker, " << base / t << "x of raster_sink\n";
+        if (n >= workers)
+            break;
+    }
+    double const mean = sumdiff / (double(data.size()) * runs);
+    std::cout << "difference from raster_sink: max. " << maxdiff << ", mean " << mean << "\n";
+    return !(mean < 0.5);
+}
@@ -0,0 +1,1041 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+#ifndef NIJI_ALGORITHM_BOOLEAN_HPP_INCLUDED
+#define NIJI_ALGORITHM_BOOLEAN_HPP_INCLUDED
+
+#include <cmath>
+#include <array>
+#include <limits>
+#include <vector>
+#include <cstddef>
+#include <numeric>
+#include <algorithm>
+#include <type_traits>
+#include <niji/render.hpp>
+#include <niji/support/command.hpp>
+#include <niji/support/point.hpp>
+#include <niji/support/vector.hpp>
+#include <niji/support/bezier.hpp>
+#include <niji/support/traits.hpp>
+#include <niji/support/fill_rule.hpp>
+
+// N O T E
+// -------
+// The operands are cut into pieces where they cross each other, so that
+// the pieces only meet at their ends, then each piece is kept if the result
+// differs on its two sides, and oriented so that the result has winding 1
+// inside and 0 outside. The kept pieces are chained into the figures, the
+// adjacent pieces of the same segment are joined back.
+//
+// The coincident lines are detected exactly, the coincident curves are only
+// detected when they're cut from the same curve.
+
+namespace niji { namespace detail
+{
+    // A segment of the operands, `kind` is the number of points.
+    template<class T>
+    struct boolean_segment
+    {
+        point<T> pts[4];
+        std::size_t v0, v1;
+        char kind;
+        char operand;
+    };
+
+    // A piece of the segment monotonic in both x & y.
+    template<class T>
+    struct boolean_edge
+    {
+        point<T> pts[4];
+        point<T> lo, hi;
+        T t0, t1;
+        std::size_t seg;
+        char kind;
+    };
+
+    template<class T>
+    struct boolean_cut
+    {
+        std::size_t seg;
+        T t;
+        std::size_t vertex;
+    };
+
+    // A piece between the cuts, which only meets the others at its ends.
+    template<class T>
+    struct boolean_piece
+    {
+        point<T> pts[4];
+        T t0, t1;
+        std::size_t seg, v0, v1, group;
+        char kind;
+        char operand;
+        bool keep;
+        bool reversed;
+    };
+
+    template<class T>
+    inline T boolean_coord(point<T> const& pt, int axis)
+    {
+        return axis ? pt.y : pt.x;
+    }
+
+    template<class T>
+    inline point<T> boolean_eval(point<T> const* pts, int kind, T t)
+    {
+        switch (kind)
+        {
+        case 2:
+            return points::interpolate(pts[0], pts[1], t);
+        case 3:
+            return {bezier::quad_eval(pts[0].x, pts[1].x, pts[2].x, t),
+                    bezier::quad_eval(pts[0].y, pts[1].y, pts[2].y, t)};
+        default:
+            return {bezier::cubic_eval(pts[0].x, pts[1].x, pts[2].x, pts[3].x, t),
+                    bezier::cubic_eval(pts[0].y, pts[1].y, pts[2].y, pts[3].y, t)};
+        }
+    }
+
+    // The part of the segment within [t0, t1].
+    template<class T>
+    void boolean_sub(point<T> const* pts, int kind, T t0, T t1, point<T>* out)
+    {
+        if (kind == 2)
+        {
+            out[0] = points::interpolate(pts[0], pts[1], t0);
+            out[1] = points::interpolate(pts[0], pts[1], t1);
+            return;
+        }
+        point<T> tmp[7];
+        std::copy(pts, pts + kind, out);
+        auto chop = [&](T t)
+        {
+            if (kind == 3)
+                bezier::chop_quad_at(out, tmp, t);
+            else
+                bezier::chop_cubic_at(out, tmp, t);
+        };
+        if (t1 < 1)
+        {
+            chop(t1);
+            std::copy(tmp, tmp + kind, out);
+        }
+        if (t0 > 0)
+        {
+            chop(t0 / t1);
+            std::copy(tmp + kind - 1, tmp + 2 * kind - 1, out);
+        }
+    }
+
+    // out[0, kind) & out[kind - 1, 2 * kind - 1) are the halves.
+    template<class T>
+    void boolean_chop_half(point<T> const* pts, int kind, point<T>* out)
+    {
+        switch (kind)
+        {
+        case 2:
+            out[0] = pts[0];
+            out[1] = points::middle(pts[0], pts[1]);
+            out[2] = pts[1];
+            break;
+        case 3:
+            bezier::chop_quad_at_half(pts, out);
+            break;
+        default:
+            bezier::chop_cubic_at_half(pts, out);
+        }
+    }
+
+    template<class T>
+    struct boolean_sink
+    {
+        std::vector<boolean_segment<T>>& segments;
+        std::vector<point<T>>& vertices;
+        char operand;
+
+        boolean_sink(std::vector<boolean_segment<T>>& segments, std::vector<point<T>>& vertices, char operand)
+          : segments(segments), vertices(vertices), operand(operand), _first(), _last()
+        {}
+
+        void operator()(move_to_t, point<T> const& pt)
+        {
+            _first = _last = vertices.size();
+            vertices.push_back(pt);
+        }
+
+        void operator()(line_to_t, point<T> const& pt1)
+        {
+            point<T> pts[2] = {vertices[_last], pt1};
+            push(pts, 2);
+        }
+
+        void operator()(quad_to_t, point<T> const& pt1, point<T> const& pt2)
+        {
+            point<T> pts[3] = {vertices[_last], pt1, pt2};
+            push(pts, 3);
+        }
+
+        void operator()(cubic_to_t, point<T> const& pt1, point<T> const& pt2, point<T> const& pt3)
+        {
+            point<T> pts[4] = {vertices[_last], pt1, pt2, pt3};
+            push(pts, 4);
+        }
+
+        // The open figures are closed as well, as they're filled.
+        template<end_tag E>
+        void operator()(end_tag_t<E>)
+        {
+            if (vertices[_last] != vertices[_first])
+            {
+                boolean_segment<T> seg;
+                seg.pts[0] = vertices[_last];
+                seg.pts[1] = vertices[_first];
+                seg.v0 = _last;
+                seg.v1 = _first;
+                seg.kind = 2;
+                seg.operand = operand;
+                segments.push_back(seg);
+            }
+            _last = _first;
+        }
+
+    private:
+
+        void push(point<T> const* pts, char kind)
+        {
+            if (std::all_of(pts + 1, pts + kind, [pts](point<T> const& pt) { return pt == pts[0]; }))
+                return;
+            boolean_segment<T> seg;
+            std::copy(pts, pts + kind, seg.pts);
+            seg.v0 = _last;
+            seg.v1 = _last = vertices.size();
+            seg.kind = kind;
+            seg.operand = operand;
+            vertices.push_back(pts[kind - 1]);
+            segments.push_back(seg);
+        }
+
+        std::size_t _first, _last;
+    };
+
+    // Joins the collinear lines, and omits the last line back to the start.
+    template<class T, class Sink>
+    struct boolean_writer
+    {
+        Sink& sink;
+        T eps2;
+        point<T> start = {}, cur = {}, line = {};
+        bool has_line = false;
+
+        void move_to(point<T> const& pt)
+        {
+            sink(command::move_to, pt);
+            start = cur = pt;
+            has_line = false;
+        }
+
+        void line_to(point<T> const& pt)
+        {
+            if (has_line)
+            {
+                vector<T> const d(pt - cur), v(line - cur);
+                T const c = vectors::cross(d, v);
+                if (vectors::dot(v, pt - line) > 0 && c * c <= eps2 * vectors::norm_square(d))
+                {
+                    line = pt;
+                    return;
+                }
+                flush();
+            }
+            line = pt;
+            has_line = true;
+        }
+
+        void curve_to(point<T> const* pts, int kind)
+        {
+            flush();
+            if (kind == 3)
+                sink(command::quad_to, pts[1], pts[2]);
+            else
+                sink(command::cubic_to, pts[1], pts[2], pts[3]);
+            cur = pts[kind - 1];
+        }
+
+        void close()
+        {
+            if (has_line && line != start)
+                flush();
+            sink(command::end_closed);
+        }
+
+    private:
+
+        void flush()
+        {
+            if (has_line)
+            {
+                sink(command::line_to, line);
+                cur = line;
+                has_line = false;
+            }
+        }
+    };
+
+    template<class T>
+    class boolean_solver
+    {
+        using point_t = point<T>;
+        using edge_t = boolean_edge<T>;
+        using piece_t = boolean_piece<T>;
+
+        // Limits of the subdivision for each pair of curves.
+        static constexpr unsigned max_depth = 52;
+        static constexpr unsigned max_steps = 1 << 12;
+
+    public:
+
+        template<class Path>
+        void add(Path const& path, char operand)
+        {
+            boolean_sink<T> sink{_segments, _vertices, operand};
+            niji::render(path, sink);
+        }
+
+        template<class F, class Sink>
+        void solve(F const& op, fill_rule rule, Sink& sink)
+        {
+            if (_segments.empty())
+                return;
+            init_tolerance();
+            split_monotonic();
+            intersect();
+            merge_vertices();
+            build_pieces();
+            classify(op, rule);
+            emit(sink);
+        }
+
+    private:
+
+        void init_tolerance()
+        {
+            using std::abs;
+
+            T scale = 0;
+            for (auto const& seg : _segments)
+            {
+                for (int i = 0; i != seg.kind; ++i)
+                    scale = std::max({scale, abs(seg.pts[i].x), abs(seg.pts[i].y)});
+            }
+            _eps = std::max(scale * std::pow(std::numeric_limits<T>::epsilon(), T(0.75)), std::numeric_limits<T>::min());
+            _eps2 = _eps * _eps;
+        }
+
+        // Cuts the segments at the extrema in x & y.
+        void split_monotonic()
+        {
+            for (std::size_t s = 0; s != _segments.size(); ++s)
+            {
+                auto const& seg = _segments[s];
+                point_t const* pts = seg.pts;
+                T ts[6] = {0};
+                T* end = ts + 1;
+                if (seg.kind == 3)
+                {
+                    end = find_quad_extrema(pts[0].x, pts[1].x, pts[2].x, end);
+                    end = find_quad_extrema(pts[0].y, pts[1].y, pts[2].y, end);
+                }
+                else if (seg.kind == 4)
+                {
+                    end = find_cubic_extrema(pts[0].x, pts[1].x, pts[2].x, pts[3].x, end);
+                    end = find_cubic_extrema(pts[0].y, pts[1].y, pts[2].y, pts[3].y, end);
+                }
+                *end++ = 1;
+                // At most 6 of them.
+                for (T* i = ts + 1; i != end; ++i)
+                {
+                    for (T* j = i; j != ts && *j < j[-1]; --j)
+                        std::swap(*j, j[-1]);
+                }
+                end = std::unique(ts, end);
+                for (T* it = ts; it + 1 != end; ++it)
+                {
+                    edge_t e;
+                    boolean_sub(pts, seg.kind, it[0], it[1], e.pts);
+                    point_t const& a = e.pts[0];
+                    point_t const& b = e.pts[seg.kind - 1];
+                    e.lo = point_t(std::min(a.x, b.x), std::min(a.y, b.y));
+                    e.hi = point_t(std::max(a.x, b.x), std::max(a.y, b.y));
+                    e.t0 = it[0];
+                    e.t1 = it[1];
+                    e.seg = s;
+                    e.kind = seg.kind;
+                    _edges.push_back(e);
+                    if (it != ts)
+                    {
+                        _cuts.push_back({s, it[0], _vertices.size()});
+                        _vertices.push_back(a);
+                    }
+                }
+            }
+        }
+
+        // Sweeps the edges along x, each edge is tested against the active
+        // ones overlapping in y.
+        void intersect()
+        {
+            std::vector<std::size_t> order(_edges.size()), active;
+            std::iota(order.begin(), order.end(), std::size_t(0));
+            std::sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b)
+            {
+                return _edges[a].lo.x < _edges[b].lo.x;
+            });
+            for (auto i : order)
+            {
+                edge_t const& e = _edges[i];
+                std::size_t n = 0;
+                for (std::size_t j = 0; j != active.size(); ++j)
+                {
+                    edge_t const& a = _edges[active[j]];
+                    if (a.hi.x + _eps < e.lo.x)
+                        continue;
+                    active[n++] = active[j];
+                    if (a.lo.y > e.hi.y + _eps || e.lo.y > a.hi.y + _eps)
+                        continue;
+                    // The adjacent pieces of a segment only meet at the cut.
+                    if (a.seg == e.seg && (a.t1 == e.t0 || e.t1 == a.t0))
+                        continue;
+                    if (a.kind == 2 && e.kind == 2)
+                    {
+                        line_line(a.pts[0], a.pts[1], e.pts[0], e.pts[1], [&](T s, T u, point_t const& pt)
+                        {
+                            hit(a, s, e, u, pt);
+                        });
+                    }
+                    else
+                    {
+                        _steps = max_steps;
+                        subdivide(a, a.pts, 0, 1, e, e.pts, 0, 1, 0);
+                    }
+                }
+                active.resize(n);
+                active.push_back(i);
+            }
+        }
+
+        // The endpoints close to the other line are the hits, which also
+        // cover the overlaps of collinear lines.
+        template<class F>
+        void line_line(point_t const& p0, point_t const& p1, point_t const& q0, point_t const& q1, F&& f)
+        {
+            vector<T> const r(p1 - p0), s(q1 - q0);
+            T const rr = vectors::norm_square(r), ss = vectors::norm_square(s);
+            T t;
+            auto near = [&](point_t const& pt, point_t const& a, vector<T> const& d, T dd)
+            {
+                t = dd > 0 ? std::min(std::max(vectors::dot(pt - a, d) / dd, T(0)), T(1)) : T(0);
+                return vectors::norm_square(a + d * t - pt) <= _eps2;
+            };
+            bool touched = false;
+            if (near(q0, p0, r, rr))
+                f(t, T(0), q0), touched = true;
+            if (near(q1, p0, r, rr))
+                f(t, T(1), q1), touched = true;
+            if (near(p0, q0, s, ss))
+                f(T(0), t, p0), touched = true;
+            if (near(p1, q0, s, ss))
+                f(T(1), t, p1), touched = true;
+            if (touched)
+                return;
+            T const den = vectors::cross(r, s);
+            if (!den)
+                return;
+            vector<T> const qp(q0 - p0);
+            T const u = vectors::cross(qp, r) / den;
+            t = vectors::cross(qp, s) / den;
+            if (0 <= t && t <= 1 && 0 <= u && u <= 1)
+                f(t, u, p0 + r * t);
+        }
+
+        bool is_flat(point_t const* pts, int kind) const
+        {
+            if (kind == 2)
+                return true;
+            vector<T> const d(pts[kind - 1] - pts[0]);
+            T const dd = vectors::norm_square(d);
+            for (int i = 1; i != kind - 1; ++i)
+            {
+                vector<T> const v(pts[i] - pts[0]);
+                if (dd > 0)
+                {
+                    T const c = vectors::cross(d, v);
+                    if (c * c > _eps2 * dd)
+                        return false;
+                }
+                else if (vectors::norm_square(v) > _eps2)
+                    return false;
+            }
+            return true;
+        }
+
+        // Whether the points of b are all on one side of the fat line of a,
+        // i.e. the band along the chord of a that holds its control points.
+        // Unlike waiting for a to be flat, it soon parts the curves that run
+        // close to each other for long.
+        bool apart(point_t const* ap, int an, point_t const* bp, int bn) const
+        {
+            vector<T> const d(ap[an - 1] - ap[0]);
+            T const tol = _eps * vectors::norm(d);
+            T lo = -tol, hi = tol;
+            for (int i = 1; i < an - 1; ++i)
+            {
+                T const c = vectors::cross(d, ap[i] - ap[0]);
+                lo = std::min(lo, c - tol);
+                hi = std::max(hi, c + tol);
+            }
+            int side = 0;
+            for (int i = 0; i != bn; ++i)
+            {
+                T const c = vectors::cross(d, bp[i] - ap[0]);
+                int const s = c > hi ? 1 : c < lo ? -1 : 0;
+                if (!s || (side && s != side))
+                    return false;
+                side = s;
+            }
+            return true;
+        }
+
+        // Whether the pieces meet only at a common end of their edges (e.g.
+        // the consecutive segments), i.e. seen from the end, a line through
+        // it parts the control points. Otherwise a sharp corner would take
+        // the subdivision down to the end.
+        bool meet_apart(point_t const* ap, int an, bool a0, bool a1,
+            point_t const* bp, int bn, bool b0, bool b1) const
+        {
+            int ia, ib;
+            if (a0 && b0 && ap[0] == bp[0])
+                ia = 0, ib = 0;
+            else if (a0 && b1 && ap[0] == bp[bn - 1])
+                ia = 0, ib = bn - 1;
+            else if (a1 && b0 && ap[an - 1] == bp[0])
+                ia = an - 1, ib = 0;
+            else if (a1 && b1 && ap[an - 1] == bp[bn - 1])
+                ia = an - 1, ib = bn - 1;
+            else
+                return false;
+            point_t const& p = ap[ia];
+            // If any, there's such a line along the rim of the cone of a.
+            for (int k = 0; k != an; ++k)
+            {
+                vector<T> const d(ap[k] - p);
+                if (k == ia || !vectors::norm_square(d))
+                    continue;
+                for (T const sign : {T(1), T(-1)})
+                {
+                    bool ok = true;
+                    for (int i = 0; i != an && ok; ++i)
+                        ok = sign * vectors::cross(d, ap[i] - p) >= 0;
+                    for (int i = 0; i != bn && ok; ++i)
+                        ok = i == ib || bp[i] == p || sign * vectors::cross(d, bp[i] - p) < 0;
+                    if (ok)
+                        return true;
+                }
+            }
+            return false;
+        }
+
+        // Bisects the curves until both are flat, the curves are monotonic
+        // so the bounds of the ends bound the curves.
+        void subdivide(edge_t const& a, point_t const* ap, T a0, T a1,
+            edge_t const& b, point_t const* bp, T b0, T b1, unsigned depth)
+        {
+            point_t const& pa = ap[a.kind - 1];
+            point_t const& pb = bp[b.kind - 1];
+            if (std::max(ap[0].x, pa.x) + _eps < std::min(bp[0].x, pb.x) ||
+                std::max(bp[0].x, pb.x) + _eps < std::min(ap[0].x, pa.x) ||
+                std::max(ap[0].y, pa.y) + _eps < std::min(bp[0].y, pb.y) ||
+                std::max(bp[0].y, pb.y) + _eps < std::min(ap[0].y, pa.y))
+                return;
+            if (meet_apart(ap, a.kind, a0 == 0, a1 == 1, bp, b.kind, b0 == 0, b1 == 1))
+                return;
+            if (apart(ap, a.kind, bp, b.kind) || apart(bp, b.kind, ap, a.kind))
+                return;
+            bool const flat_a = is_flat(ap, a.kind), flat_b = is_flat(bp, b.kind);
+            if (!_steps)
+                return;
+            if ((flat_a && flat_b) || depth == max_depth)
+            {
+                line_line(ap[0], pa, bp[0], pb, [&](T s, T u, point_t const& pt)
+                {
+                    hit(a, a0 + s * (a1 - a0), b, b0 + u * (b1 - b0), pt);
+                });
+                return;
+            }
+            --_steps;
+            point_t tmp[7];
+            bool const split_a = !flat_a && (flat_b ||
+                vectors::norm_square(pa - ap[0]) >= vectors::norm_square(pb - bp[0]));
+            if (split_a)
+            {
+                T const m = (a0 + a1) / 2;
+                boolean_chop_half(ap, a.kind, tmp);
+                subdivide(a, tmp, a0, m, b, bp, b0, b1, depth + 1);
+                subdivide(a, tmp + a.kind - 1, m, a1, b, bp, b0, b1, depth + 1);
+            }
+            else
+            {
+                T const m = (b0 + b1) / 2;
+                boolean_chop_half(bp, b.kind, tmp);
+                subdivide(a, ap, a0, a1, b, tmp, b0, m, depth + 1);
+                subdivide(a, ap, a0, a1, b, tmp + b.kind - 1, m, b1, depth + 1);
+            }
+        }
+
+        // `s` & `u` are the parameters of the edges.
+        void hit(edge_t const& a, T s, edge_t const& b, T u, point_t const& pt)
+        {
+            // The ends of the edges are vertices already.
+            if ((s == 0 || s == 1) && (u == 0 || u == 1))
+                return;
+            std::size_t const v = _vertices.size();
+            _vertices.push_back(pt);
+            _cuts.push_back({a.seg, a.t0 + s * (a.t1 - a.t0), v});
+            _cuts.push_back({b.seg, b.t0 + u * (b.t1 - b.t0), v});
+        }
+
+        std::size_t find(std::size_t v)
+        {
+            while (_parent[v] != v)
+                v = _parent[v] = _parent[_parent[v]];
+            return v;
+        }
+
+        // The vertices within the tolerance are merged, by the neighbor
+        // cells of a grid.
+        void merge_vertices()
+        {
+            using std::floor;
+
+            struct cell
+            {
+                long long x, y;
+                std::size_t v;
+
+                bool operator<(cell const& other) const
+                {
+                    return x < other.x || (x == other.x && y < other.y);
+                }
+            };
+
+            std::size_t const n = _vertices.size();
+            _parent.resize(n);
+            std::iota(_parent.begin(), _parent.end(), std::size_t(0));
+            T const size = 2 * _eps;
+            std::vector<cell> cells(n);
+            for (std::size_t i = 0; i != n; ++i)
+                cells[i] = {(long long)floor(_vertices[i].x / size), (long long)floor(_vertices[i].y / size), i};
+            std::sort(cells.begin(), cells.end());
+            for (auto const& c : cells)
+            {
+                for (long long dx = 0; dx != 2; ++dx)
+                {
+                    for (long long dy = -1; dy != 2; ++dy)
+                    {
+                        cell const key{c.x + dx, c.y + dy, 0};
+                        for (auto it = std::lower_bound(cells.begin(), cells.end(), key);
+                            it != cells.end() && it->x == key.x && it->y == key.y; ++it)
+                        {
+                            if (it->v != c.v && vectors::norm_square(_vertices[it->v] - _vertices[c.v]) <= _eps2)
+                            {
+                                std::size_t const a = find(it->v), b = find(c.v);
+                                if (a != b)
+                                    _parent[std::max(a, b)] = std::min(a, b);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        void build_pieces()
+        {
+            std::sort(_cuts.begin(), _cuts.end(), [](boolean_cut<T> const& a, boolean_cut<T> const& b)
+            {
+                return a.seg < b.seg || (a.seg == b.seg && a.t < b.t);
+            });
+            auto cut = _cuts.begin();
+            for (std::size_t s = 0; s != _segments.size(); ++s)
+            {
+                auto const& seg = _segments[s];
+                T t0 = 0;
+                std::size_t v0 = find(seg.v0);
+                auto next = [&](T t, std::size_t v)
+                {
+                    v = find(v);
+                    // Too short.
+                    if (v == v0)
+                        return;
+                    piece_t p;
+                    boolean_sub(seg.pts, seg.kind, t0, t, p.pts);
+                    p.pts[0] = _vertices[v0];
+                    p.pts[seg.kind - 1] = _vertices[v];
+                    p.t0 = t0;
+                    p.t1 = t;
+                    p.seg = s;
+                    p.v0 = v0;
+                    p.v1 = v;
+                    p.kind = seg.kind;
+                    p.operand = seg.operand;
+                    p.keep = false;
+                    p.reversed = false;
+                    _pieces.push_back(p);
+                    t0 = t;
+                    v0 = v;
+                };
+                for (; cut != _cuts.end() && cut->seg == s; ++cut)
+                {
+                    if (0 < cut->t && cut->t < 1)
+                        next(cut->t, cut->vertex);
+                }
+                next(T(1), seg.v1);
+            }
+        }
+
+        // The winding contributed by the piece to the ray toward -u, where
+        // v is the axis of the sweep.
+        static int contribution(piece_t const& p, int v)
+        {
+            bool const inc = boolean_coord(p.pts[p.kind - 1], v) > boolean_coord(p.pts[0], v);
+            return (inc ? 1 : -1) * (v ? 1 : -1);
+        }
+
+        // Coincident pieces share the ends and the middle, the first of
+        // them represents the group.
+        void group_pieces()
+        {
+            std::vector<std::size_t> order(_pieces.size());
+            std::iota(order.begin(), order.end(), std::size_t(0));
+            auto key = [this](std::size_t i)
+            {
+                auto const& p = _pieces[i];
+                return std::make_pair(std::min(p.v0, p.v1), std::max(p.v0, p.v1));
+            };
+            std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b)
+            {
+                return key(a) < key(b);
+            });
+            T const tol = _eps2 * 256;
+            for (auto it = order.begin(); it != order.end(); )
+            {
+                auto const k = key(*it);
+                auto last = std::find_if(it, order.end(), [&](std::size_t i) { return key(i) != k; });
+                for (auto p = it; p != last; ++p)
+                {
+                    auto& piece = _pieces[*p];
+                    piece.group = *p;
+                    point_t const mid = boolean_eval(piece.pts, piece.kind, T(0.5));
+                    for (auto q = it; q != p; ++q)
+                    {
+                        auto const& other = _pieces[*q];
+                        if (other.group == *q &&
+                            vectors::norm_square(boolean_eval(other.pts, other.kind, T(0.5)) - mid) <= tol)
+                        {
+                            piece.group = *q;
+                            break;
+                        }
+                    }
+                }
+                it = last;
+            }
+        }
+
+        // The coordinate u on the piece at v, the piece spans v.
+        static T coord_at(piece_t const& p, int v, T val)
+        {
+            int const u = 1 - v;
+            point_t const* pts = p.pts;
+            T const a = boolean_coord(pts[0], v), b = boolean_coord(pts[p.kind - 1], v);
+            T ts[3], t;
+            T* end = ts;
+            switch (p.kind)
+            {
+            case 2:
+                return boolean_coord(points::interpolate(pts[0], pts[1], (val - a) / (b - a)), u);
+            case 3:
+                end = bezier::quad_solve(a, boolean_coord(pts[1], v), b, val, ts);
+                break;
+            default:
+                end = bezier::cubic_solve(a, boolean_coord(pts[1], v), boolean_coord(pts[2], v), b, val, ts);
+            }
+            if (end != ts)
+                t = ts[0];
+            else
+                t = std::abs(val - a) < std::abs(val - b) ? T(0) : T(1);
+            return boolean_coord(boolean_eval(pts, p.kind, t), u);
+        }
+
+        // Casts the rays toward -u from the queries, by sweeping the pieces
+        // along v. Each ray skips the group of its query.
+        void cast(std::vector<std::size_t>& queries, std::vector<point_t> const& mids, int v, std::array<int, 2>* windings)
+        {
+            struct span
+            {
+                T vlo, vhi, ulo, uhi;
+                std::size_t index, group;
+                int operand, contribution;
+            };
+            int const u = 1 - v;
+            std::vector<span> order, active;
+            for (std::size_t i = 0; i != _pieces.size(); ++i)
+            {
+                auto const& p = _pieces[i];
+                T const a = boolean_coord(p.pts[0], v), b = boolean_coord(p.pts[p.kind - 1], v);
+                if (a == b)
+                    continue;
+                T umin = boolean_coord(p.pts[0], u), umax = umin;
+                for (int k = 1; k != p.kind; ++k)
+                {
+                    umin = std::min(umin, boolean_coord(p.pts[k], u));
+                    umax = std::max(umax, boolean_coord(p.pts[k], u));
+                }
+                order.push_back(span{std::min(a, b), std::max(a, b), umin, umax,
+                    i, p.group, int(p.operand), contribution(p, v)});
+            }
+            std::sort(order.begin(), order.end(), [](span const& a, span const& b) { return a.vlo < b.vlo; });
+            std::sort(queries.begin(), queries.end(), [&](std::size_t a, std::size_t b)
+            {
+                return boolean_coord(mids[a], v) < boolean_coord(mids[b], v);
+            });
+            auto next = order.begin();
+            for (auto q : queries)
+            {
+                T const qv = boolean_coord(mids[q], v), qu = boolean_coord(mids[q], u);
+                std::size_t const group = _pieces[q].group;
+                for (; next != order.end() && next->vlo <= qv; ++next)
+                    active.push_back(*next);
+                auto& w = windings[q];
+                // The expired pieces are dropped on the way.
+                auto out = active.begin();
+                for (auto const& s : active)
+                {
+                    if (s.vhi <= qv)
+                        continue;
+                    *out++ = s;
+                    if (s.group == group || s.ulo >= qu ||
+                        (s.uhi >= qu && coord_at(_pieces[s.index], v, qv) >= qu))
+                        continue;
+                    w[s.operand] += s.contribution;
+                }
+                active.erase(out, active.end());
+            }
+        }
+
+        template<class F>
+        void classify(F const& op, fill_rule rule)
+        {
+            group_pieces();
+            std::size_t const n = _pieces.size();
+            std::vector<point_t> mids(n);
+            std::vector<int> axes(n);
+            std::vector<std::size_t> queries[2];
+            // The sums of the groups, for each axis & operand.
+            std::vector<std::array<int, 2>> sums[2];
+            sums[0].assign(n, {{0, 0}});
+            sums[1].assign(n, {{0, 0}});
+            for (std::size_t i = 0; i != n; ++i)
+            {
+                auto const& p = _pieces[i];
+                sums[0][p.group][int(p.operand)] += contribution(p, 0);
+                sums[1][p.group][int(p.operand)] += contribution(p, 1);
+                if (p.group != i)
+                    continue;
+                vector<T> const d(p.pts[p.kind - 1] - p.pts[0]);
+                mids[i] = boolean_eval(p.pts, p.kind, T(0.5));
+                // The ray across the piece.
+                axes[i] = std::abs(d.y) >= std::abs(d.x);
+                queries[axes[i]].push_back(i);
+            }
+            std::vector<std::array<int, 2>> windings(n, {{0, 0}});
+            cast(queries[0], mids, 0, windings.data());
+            cast(queries[1], mids, 1, windings.data());
+
+            auto inside = [rule](int w)
+            {
+                return rule == fill_rule::evenodd ? (w & 1) != 0 : w != 0;
+            };
+            for (std::size_t i = 0; i != n; ++i)
+            {
+                auto& p = _pieces[i];
+                if (p.group != i)
+                    continue;
+                int const v = axes[i];
+                auto const& w = windings[i];
+                auto const& s = sums[v][i];
+                bool const minus = op(inside(w[0]), inside(w[1]));
+                bool const plus = op(inside(w[0] + s[0]), inside(w[1] + s[1]));
+                if (minus == plus)
+                    continue;
+                p.keep = true;
+                p.reversed = contribution(p, v) != (plus ? 1 : -1);
+            }
+        }
+
+        std::size_t start_of(piece_t const& p) const
+        {
+            return p.reversed ? p.v1 : p.v0;
+        }
+
+        std::size_t end_of(piece_t const& p) const
+        {
+            return p.reversed ? p.v0 : p.v1;
+        }
+
+        // Chains the kept pieces into the closed figures.
+        template<class Sink>
+        void emit(Sink& sink)
+        {
+            std::vector<std::size_t> kept;
+            for (std::size_t i = 0; i != _pieces.size(); ++i)
+            {
+                if (_pieces[i].keep)
+                    kept.push_back(i);
+            }
+            std::vector<std::size_t> by_start(kept);
+            std::stable_sort(by_start.begin(), by_start.end(), [this](std::size_t a, std::size_t b)
+            {
+                return start_of(_pieces[a]) < start_of(_pieces[b]);
+            });
+            std::vector<bool> used(_pieces.size());
+            boolean_writer<T, Sink> writer{sink, _eps2};
+            auto follow = [&](piece_t const& p) -> std::size_t
+            {
+                std::size_t const v = end_of(p);
+                auto it = std::lower_bound(by_start.begin(), by_start.end(), v, [this](std::size_t i, std::size_t v)
+                {
+                    return start_of(_pieces[i]) < v;
+                });
+                std::size_t ret = std::size_t(-1);
+                for (; it != by_start.end() && start_of(_pieces[*it]) == v; ++it)
+                {
+                    if (used[*it])
+                        continue;
+                    auto const& q = _pieces[*it];
+                    // Prefer the continuation of the same segment.
+                    if (q.seg == p.seg && q.reversed == p.reversed)
+                        return *it;
+                    if (ret == std::size_t(-1))
+                        ret = *it;
+                }
+                return ret;
+            };
+
+            for (auto i : kept)
+            {
+                if (used[i])
+                    continue;
+                std::size_t const start = start_of(_pieces[i]);
+                writer.move_to(_vertices[start]);
+                piece_t run = _pieces[i];
+                used[i] = true;
+                for (std::size_t j = i; ; )
+                {
+                    if (end_of(_pieces[j]) == start)
+                        break;
+                    j = follow(_pieces[j]);
+                    if (j == std::size_t(-1))
+                        break;
+                    used[j] = true;
+                    auto const& p = _pieces[j];
+                    // Join the adjacent pieces of the same segment.
+                    if (p.seg == run.seg && p.reversed == run.reversed &&
+                        (run.reversed ? p.t1 == run.t0 : p.t0 == run.t1))
+                    {
+                        if (run.reversed)
+                            run.t0 = p.t0, run.v0 = p.v0;
+                        else
+                            run.t1 = p.t1, run.v1 = p.v1;
+                    }
+                    else
+                    {
+                        render_piece(run, writer);
+                        run = p;
+                    }
+                }
+                render_piece(run, writer);
+                writer.close();
+            }
+        }
+
+        template<class Writer>
+        void render_piece(piece_t const& p, Writer& writer) const
+        {
+            int const kind = p.kind;
+            point_t pts[4];
+            boolean_sub(_segments[p.seg].pts, kind, p.t0, p.t1, pts);
+            pts[0] = _vertices[p.v0];
+            pts[kind - 1] = _vertices[p.v1];
+            if (p.reversed)
+                std::reverse(pts, pts + kind);
+            if (kind == 2)
+                writer.line_to(pts[1]);
+            else
+                writer.curve_to(pts, kind);
+        }
+
+        std::vector<boolean_segment<T>> _segments;
+        std::vector<point_t> _vertices;
+        std::vector<edge_t> _edges;
+        std::vector<boolean_cut<T>> _cuts;
+        std::vector<std::size_t> _parent;
+        std::vector<piece_t> _pieces;
+        T _eps, _eps2;
+        unsigned _steps;
+    };
+
+    template<class Path1, class Path2, class Sink, class F>
+    void path_boolean(Path1 const& a, Path2 const& b, Sink& sink, fill_rule rule, F const& op)
+    {
+        using coord_t = std::common_type_t<path_coordinate_t<Path1>, path_coordinate_t<Path2>, float>;
+        boolean_solver<coord_t> solver;
+        solver.add(a, 0);
+        solver.add(b, 1);
+        solver.solve(op, rule, sink);
+    }
+}}
+
+namespace niji
+{
+    // Boolean operations on the areas of the paths filled by `rule`, the
+    // curves are kept as curves. The result is sent to the sink as closed
+    // figures, with winding 1 inside and 0 outside, so it can be filled by
+    // either rule.
+    template<class Path1, class Path2, class Sink>
+    void path_union(Path1 const& a, Path2 const& b, Sink& sink, fill_rule rule = fill_rule::nonzero)
+    {
+        detail::path_boolean(a, b, sink, rule, [](bool a, bool b) { return a || b; });
+    }
+
+    template<class Path1, class Path2, class Sink>
+    void path_intersection(Path1 const& a, Path2 const& b, Sink& sink, fill_rule rule = fill_rule::nonzero)
+    {
+        detail::path_boolean(a, b, sink, rule, [](bool a, bool b) { return a && b; });
+    }
+
+    template<class Path1, class Path2, class Sink>
+    void path_difference(Path1 const& a, Path2 const& b, Sink& sink, fill_rule rule = fill_rule::nonzero)
+    {
+        detail::path_boolean(a, b, sink, rule, [](bool a, bool b) { return a && !b; });
+    }
+
+    template<class Path1, class Path2, class Sink>
+    void path_xor(Path1 const& a, Path2 const& b, Sink& sink, fill_rule rule = fill_rule::nonzero)
+    {
+        detail::path_boolean(a, b, sink, rule, [](bool a, bool b) { return a != b; });
+    }
+}
+
+#endif
@@ -7,10 +7,12 @@
 #ifndef NIJI_ALGORITHM_BOUNDS_HPP_INCLUDED
 #define NIJI_ALGORITHM_BOUNDS_HPP_INCLUDED
 
+#include <type_traits>
 #include <boost/assert.hpp>
 #include <boost/integer.hpp>
 #include <boost/numeric/conversion/bounds.hpp>
 #include <niji/render.hpp>
+#include <niji/detail/priority.hpp>
 #include <niji/support/command.hpp>
 #include <niji/support/vector.hpp>
 #include <niji/support/point.hpp>
@@ -174,19 +176,87 @@ namespace niji { namespace detail
         point<T> _prev;
         bool _moving;
     };
-}}
 
-namespace niji
-{
+    // Bounds of the control points, no root solving involved.
+    template<class T>
+    struct control_bounds_sink
+    {
+        point<T> min, max;
+
+        control_bounds_sink()
+          : min(boost::numeric::bounds<T>::highest(), boost::numeric::bounds<T>::highest())
+          , max(boost::numeric::bounds<T>::lowest(), boost::numeric::bounds<T>::lowest())
+        {}
+
+        template<class Tag, class... Points>
+        void operator()(Tag, Points const&... pts)
+        {
+            bool _[] = {(adjust(pts), true)..., true};
+            (void)_;
+        }
+
+        void adjust(point<T> const& pt)
+        {
+            if (pt.x < min.x)
+                min.x = pt.x;
+            if (pt.x > max.x)
+                max.x = pt.x;
+            if (pt.y < min.y)
+                min.y = pt.y;
+            if (pt.y > max.y)
+                max.y = pt.y;
+        }
+    };
+
     template<class Path>
-    auto bounds(Path const& path)
+    inline auto bounds_dispatch(priority<1>, Path const& path) -> std::decay_t<decltype(path.bounds())>
+    {
+        return path.bounds();
+    }
+
+    template<class Path>
+    inline auto bounds_dispatch(priority<0>, Path const& path)
     {
         using coord_t = path_coordinate_t<Path>;
         using point_t = point<coord_t>;
-        detail::bounds_sink<coord_t> bounds;
+        bounds_sink<coord_t> bounds;
         niji::render(path, bounds);
         return box<point_t>(bounds.min, bounds.max);
     }
+
+    template<class Path>
+    inline auto control_bounds_dispatch(priority<1>, Path const& path) -> std::decay_t<decltype(path.control_bounds())>
+    {
+        return path.control_bounds();
+    }
+
+    template<class Path>
+    inline auto control_bounds_dispatch(priority<0>, Path const& path)
+    {
+        using coord_t = path_coordinate_t<Path>;
+        using point_t = point<coord_t>;
+        control_bounds_sink<coord_t> bounds;
+        niji::render(path, bounds);
+        return box<point_t>(bounds.min, bounds.max);
+    }
+}}
+
+namespace niji
+{
+    // Uses the bounds of the path if it provides them, e.g. bounded_path.
+    template<class Path>
+    auto bounds(Path const& path)
+    {
+        return detail::bounds_dispatch(detail::priority<1>{}, path);
+    }
+
+    // The box of all the points including the control points of the curves,
+    // which contains the tight bounds.
+    template<class Path>
+    auto control_bounds(Path const& path)
+    {
+        return detail::control_bounds_dispatch(detail::priority<1>{}, path);
+    }
 }
 
 #endif
\ No newline at end of file
@@ -7,11 +7,19 @@
 #ifndef NIJI_ALGORITHM_CONTAINS_HPP_INCLUDED
 #define NIJI_ALGORITHM_CONTAINS_HPP_INCLUDED
 
+#include <iterator>
+#include <algorithm>
 #include <niji/render.hpp>
 #include <niji/support/command.hpp>
 #include <niji/support/vector.hpp>
 #include <niji/support/point.hpp>
 #include <niji/support/bezier.hpp>
+#include <niji/detail/priority.hpp>
+
+// Number of points tested per traversal by contains_many.
+#ifndef NIJI_CONTAINS_BLOCK_SIZE
+#   define NIJI_CONTAINS_BLOCK_SIZE 256
+#endif
 
 // N O T E
 // -------
@@ -315,28 +323,191 @@ namespace niji { namespace detail
     private:
         point<T> _pt, _pt0, _first;
     };
-}}
 
-namespace niji
-{
-    template<class Path>
-    bool contains(Path const& path, path_point_t<Path> pt)
+    // Winding of a block of points, the path is traversed once per block.
+    // The points are sorted by y and kept in separate x & y arrays, so each
+    // segment only visits the points within its y-range, and lines (the
+    // common case) are tested by a branchless kernel the compiler can
+    // vectorize.
+    template<class T>
+    struct contains_many_sink
     {
-        using coord_t = path_coordinate_t<Path>;
-        detail::contains_sink<coord_t> test{pt};
-        niji::render(path, test);
-        if (test.winding)
+        static constexpr std::size_t capacity = NIJI_CONTAINS_BLOCK_SIZE;
+
+        std::size_t size = 0;
+        std::size_t order[capacity];
+        T xs[capacity], ys[capacity];
+        int winding[capacity], on_curve_count[capacity];
+
+        // Loads the next block from [it, end).
+        template<class Iter>
+        Iter load(Iter it, Iter const& end)
+        {
+            point<T> pts[capacity];
+            for (size = 0; it != end && size != capacity; ++it, ++size)
+            {
+                pts[size] = point<T>(*it);
+                order[size] = size;
+            }
+            std::sort(order, order + size, [&pts](std::size_t a, std::size_t b)
+            {
+                return pts[a].y < pts[b].y;
+            });
+            for (std::size_t i = 0; i != size; ++i)
+            {
+                xs[i] = pts[order[i]].x;
+                ys[i] = pts[order[i]].y;
+            }
+            std::fill_n(winding, size, 0);
+            std::fill_n(on_curve_count, size, 0);
+            return it;
+        }
+
+        void operator()(move_to_t, point<T> const& pt)
+        {
+            _first = _pt0 = pt;
+        }
+
+        // Same as winding_line for each point.
+        void operator()(line_to_t, point<T> const& pt1)
+        {
+            T const x0 = _pt0.x, y0 = _pt0.y, x1 = pt1.x, y1 = pt1.y;
+            T const dx = x1 - x0, dy = y1 - y0;
+            T const ymin = std::min(y0, y1), ymax = std::max(y0, y1);
+            int const dir = y0 > y1 ? -1 : 1;
+            int const flat = y0 == y1;
+            // Bitwise ops instead of logical ones to keep the loop branchless.
+            for (std::size_t i = lower(ymin), n = upper(ymax); i != n; ++i)
+            {
+                T const x = xs[i], y = ys[i];
+                int const on = (flat & ((x0 - x) * (x1 - x) <= 0) & (x != x1))
+                    | (!flat & (x == x0) & (y == y0));
+                int const rest = !on & (y != ymax);
+                T const cross = dx * (y - y0) - dy * (x - x0);
+                int const zero = cross == 0;
+                on_curve_count[i] += on + (rest & zero & ((x != x1) | (y != y1)));
+                winding[i] += (rest & !zero & (cross * dir < 0)) * dir;
+            }
+            _pt0 = pt1;
+        }
+
+        void operator()(quad_to_t, point<T> const& pt1, point<T> const& pt2)
+        {
+            point<T> pts[3] = {_pt0, pt1, pt2}, dst[5];
+            point<T> const* src = pts;
+            int n = 0;
+            if (!bezier::is_mono_quad(pts[0].y, pts[1].y, pts[2].y))
+            {
+                n = bezier::chop_quad_at_extrema<1>(pts, dst);
+                src = dst;
+            }
+            for (int k = 0; k <= n; ++k)
+                each(src + k * 2, 2, winding_mono_quad<T>);
+            _pt0 = pt2;
+        }
+
+        void operator()(cubic_to_t, point<T> const& pt1, point<T> const& pt2, point<T> const& pt3)
+        {
+            point<T> pts[4] = {_pt0, pt1, pt2, pt3}, dst[10];
+            int n = bezier::chop_cubic_at_extrema<1>(pts, dst);
+            for (int k = 0; k <= n; ++k)
+                each(dst + k * 3, 3, winding_mono_cubic<T>);
+            _pt0 = pt3;
+        }
+
+        void operator()(end_open_t) {}
+
+        void operator()(end_closed_t)
+        {
+            operator()(line_to_t{}, _first);
+        }
+
+    private:
+
+        // The curve is chopped once for the block, only the points within
+        // its y-range go through the scalar test.
+        template<class F>
+        void each(point<T> const* pts, int last, F f)
+        {
+            T const ymin = std::min(pts[0].y, pts[last].y);
+            T const ymax = std::max(pts[0].y, pts[last].y);
+            for (std::size_t i = lower(ymin), n = upper(ymax); i != n; ++i)
+                winding[i] += f(pts, point<T>(xs[i], ys[i]), on_curve_count[i]);
+        }
+
+        std::size_t lower(T y) const
+        {
+            return std::lower_bound(ys, ys + size, y) - ys;
+        }
+
+        std::size_t upper(T y) const
+        {
+            return std::upper_bound(ys, ys + size, y) - ys;
+        }
+
+        point<T> _pt0, _first;
+    };
+
+    inline bool contains_result(int winding, int on_curve_count)
+    {
+        if (winding)
             return true;
-        if (test.on_curve_count <= 1)
-            return !!test.on_curve_count;
-        if (test.on_curve_count & 1)
+        if (on_curve_count <= 1)
+            return !!on_curve_count;
+        if (on_curve_count & 1)
             return true;
-        
+
         // TODO:
         // If the point touches an even number of curves, and the fill is winding, check for
         // coincidence. Count coincidence as places where the on curve points have identical tangents.
         return false;
     }
+
+    template<class Path, class Point>
+    inline auto contains_dispatch(priority<1>, Path const& path, Point const& pt) ->
+        decltype(path.contains(pt))
+    {
+        return path.contains(pt);
+    }
+
+    template<class Path, class Point>
+    inline bool contains_dispatch(priority<0>, Path const& path, Point const& pt)
+    {
+        using coord_t = path_coordinate_t<Path>;
+        contains_sink<coord_t> test{pt};
+        niji::render(path, test);
+        return contains_result(test.winding, test.on_curve_count);
+    }
+}}
+
+namespace niji
+{
+    template<class Path>
+    bool contains(Path const& path, path_point_t<Path> pt)
+    {
+        return detail::contains_dispatch(detail::priority<1>{}, path, pt);
+    }
+
+    // Tests each of the points, writes the results to out in order.
+    // Same as calling contains for each point, but the path is traversed
+    // once per block of NIJI_CONTAINS_BLOCK_SIZE points.
+    template<class Path, class Points, class OutIt>
+    OutIt contains_many(Path const& path, Points const& pts, OutIt out)
+    {
+        using coord_t = path_coordinate_t<Path>;
+        using sink_t = detail::contains_many_sink<coord_t>;
+        sink_t test;
+        bool result[sink_t::capacity];
+        for (auto it = std::begin(pts), end = std::end(pts); it != end; )
+        {
+            it = test.load(it, end);
+            niji::render(path, test);
+            for (std::size_t i = 0; i != test.size; ++i)
+                result[test.order[i]] = detail::contains_result(test.winding[i], test.on_curve_count[i]);
+            out = std::copy(result, result + test.size, out);
+        }
+        return out;
+    }
 }
 
 #endif
\ No newline at end of file
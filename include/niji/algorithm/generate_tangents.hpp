@@ -21,7 +21,8 @@ namespace niji { namespace detail
         using point_t = point<T>;
         using vector_t = vector<T>;
 
-        tangents_sink(T step, T offset, F& f) : _step(step), _offset(), _f(f)
+        tangents_sink(T step, T offset, F& f, T tolerance = 0)
+          : _step(step), _offset(), _tolerance(tolerance), _f(f)
         {
             using std::fmod;
 
@@ -54,7 +55,7 @@ namespace niji { namespace detail
             T len(bezier::quad_length(_prev_pt, pt1, pt2));
             do_act(len, [&](T sum, T len)
             {
-                bezier::curve_bisect(NIJI_MAX_QUAD_SUBDIVIDE, sum, len, [&](T t)
+                bezier::curve_bisect(NIJI_MAX_QUAD_SUBDIVIDE, sum, len, _tolerance, [&](T t)
                 {
                     bezier::chop_quad_at(pts, chops, t);
                     return bezier::quad_length(chops[0], chops[1], chops[2]);
@@ -71,7 +72,7 @@ namespace niji { namespace detail
             T len(bezier::cubic_length(_prev_pt, pt1, pt2, pt3));
             do_act(len, [&](T sum, T len)
             {
-                bezier::curve_bisect(NIJI_MAX_CUBIC_SUBDIVIDE, sum, len, [&](T t)
+                bezier::curve_bisect(NIJI_MAX_CUBIC_SUBDIVIDE, sum, len, _tolerance, [&](T t)
                 {
                     bezier::chop_cubic_at(pts, chops, t);
                     return bezier::cubic_length(chops[0], chops[1], chops[2], chops[3]);
@@ -114,6 +115,7 @@ namespace niji { namespace detail
 
         T _step;
         T _offset;
+        T _tolerance;
         F& _f;
         point_t _prev_pt, _first_pt;
     };
@@ -128,6 +130,15 @@ namespace niji
         detail::tangents_sink<coord_t, F> sink(step, offset, f);
         niji::render(path, sink);
     }
+
+    // The tangents are located within the tolerance of the arc length.
+    template<class Path, class T, class F>
+    void generate_tangents(Path const& path, T const& step, T const& offset, T const& tolerance, F&& f)
+    {
+        using coord_t = path_coordinate_t<Path>;
+        detail::tangents_sink<coord_t, F> sink(step, offset, f, tolerance);
+        niji::render(path, sink);
+    }
 }
 
 #endif
\ No newline at end of file
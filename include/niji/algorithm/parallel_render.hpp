@@ -0,0 +1,210 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+#ifndef NIJI_ALGORITHM_PARALLEL_RENDER_HPP_INCLUDED
+#define NIJI_ALGORITHM_PARALLEL_RENDER_HPP_INCLUDED
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <exception>
+#include <condition_variable>
+#include <niji/render.hpp>
+#include <niji/group.hpp>
+#include <niji/support/view.hpp>
+#include <niji/sink/recording.hpp>
+
+// Number of paths rendered by a task of parallel_render.
+#ifndef NIJI_PARALLEL_CHUNK_SIZE
+#   define NIJI_PARALLEL_CHUNK_SIZE 16
+#endif
+
+namespace niji { namespace detail
+{
+    // The members of a group with the views applied to each, i.e. for
+    // `group | v1 | v2`, the i-th member is `group[i] | v1 | v2`.
+    template<class Path, class Alloc>
+    inline std::size_t parallel_size(group<Path, Alloc> const& g)
+    {
+        return g.size();
+    }
+
+    template<class Path, class View>
+    inline std::size_t parallel_size(path_adaptor<Path, View> const& p)
+    {
+        return parallel_size(p.path);
+    }
+
+    template<class Path, class Alloc, class F>
+    inline void parallel_member(group<Path, Alloc> const& g, std::size_t i, F&& f)
+    {
+        f(g[i]);
+    }
+
+    template<class Path, class View, class F>
+    inline void parallel_member(path_adaptor<Path, View> const& p, std::size_t i, F&& f)
+    {
+        parallel_member(p.path, i, [&](auto const& member)
+        {
+            f(member | p.view);
+        });
+    }
+
+    // Runs each task on its own thread, joined on destruction.
+    struct thread_executor
+    {
+        thread_executor() = default;
+
+        thread_executor(thread_executor const&) = delete;
+
+        ~thread_executor()
+        {
+            for (auto& t : _threads)
+                t.join();
+        }
+
+        template<class F>
+        void operator()(F&& f)
+        {
+            _threads.emplace_back(std::forward<F>(f));
+        }
+
+    private:
+
+        std::vector<std::thread> _threads;
+    };
+}}
+
+namespace niji
+{
+    // Renders the members of `group | views...` concurrently, the views are
+    // applied to each member separately. The `concurrency` workers are
+    // started by `executor(task)`, each records chunks of the members, and
+    // the chunks are replayed to the sink in the original order by the
+    // calling thread, so the output is deterministic.
+    //
+    // Note that this is the same as rendering `member | views...` one after
+    // another, which differs from the sequential render of the group for
+    // the views that carry states across the figures, e.g. views::dash.
+    template<class Path, class View, class Sink, class Executor>
+    void parallel_render(path_adaptor<Path, View> const& path, Sink& sink, Executor&& executor,
+        unsigned concurrency = std::max(std::thread::hardware_concurrency(), 1u))
+    {
+        using point_t = path_point_t<path_adaptor<Path, View>>;
+        using recorder_t = recording_sink<point_t>;
+        constexpr std::size_t chunk = NIJI_PARALLEL_CHUNK_SIZE;
+
+        std::size_t const size = detail::parallel_size(path);
+        std::size_t const chunks = (size + chunk - 1) / chunk;
+        if (!chunks)
+            return;
+        std::vector<recorder_t> results(chunks);
+        std::vector<char> ready(chunks);
+        std::atomic<std::size_t> next(0);
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::size_t running = 0;
+
+        auto fail = [&](std::exception_ptr e)
+        {
+            if (!error)
+                error = e;
+            next = chunks;
+        };
+        auto worker = [&]
+        {
+            for (std::size_t i; (i = next++) < chunks; )
+            {
+                try
+                {
+                    auto& rec = results[i];
+                    for (std::size_t j = i * chunk, e = std::min(j + chunk, size); j != e; ++j)
+                    {
+                        detail::parallel_member(path, j, [&](auto const& member)
+                        {
+                            niji::render(member, rec);
+                        });
+                    }
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    fail(std::current_exception());
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                ready[i] = true;
+                cond.notify_all();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            --running;
+            cond.notify_all();
+        };
+
+        // The executor may run the worker inline, so it's not locked here.
+        try
+        {
+            for (std::size_t n = std::min<std::size_t>(std::max(concurrency, 1u), chunks); n; --n)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    ++running;
+                }
+                try
+                {
+                    executor(worker);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    --running;
+                    throw;
+                }
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            fail(std::current_exception());
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        try
+        {
+            for (std::size_t i = 0; i != chunks; ++i)
+            {
+                cond.wait(lock, [&] { return ready[i] || error; });
+                if (error)
+                    break;
+                lock.unlock();
+                niji::render(results[i], sink);
+                recorder_t().swap(results[i]);
+                lock.lock();
+            }
+        }
+        catch (...)
+        {
+            if (!lock)
+                lock.lock();
+            fail(std::current_exception());
+        }
+        // The workers refer to the locals, they must be done before leaving.
+        cond.wait(lock, [&] { return !running; });
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    // Uses a thread for each worker.
+    template<class Path, class View, class Sink>
+    void parallel_render(path_adaptor<Path, View> const& path, Sink& sink)
+    {
+        detail::thread_executor executor;
+        parallel_render(path, sink, executor);
+    }
+}
+
+#endif
@@ -0,0 +1,41 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+#ifndef NIJI_ALGORITHM_TRANSFORM_HPP_INCLUDED
+#define NIJI_ALGORITHM_TRANSFORM_HPP_INCLUDED
+
+#include <niji/path_fwd.hpp>
+#include <niji/detail/priority.hpp>
+
+namespace niji { namespace detail
+{
+    template<class Path, class F>
+    inline auto transform_in_place_dispatch(priority<1>, Path& path, F const& f)
+        -> decltype(f.transform_n(path.xs(), path.ys(), path.size(), path.xs(), path.ys()))
+    {
+        f.transform_n(path.xs(), path.ys(), path.size(), path.xs(), path.ys());
+    }
+
+    template<class Path, class F>
+    inline void transform_in_place_dispatch(priority<0>, Path& path, F const& f)
+    {
+        for (auto& pt : path)
+            pt = f(pt);
+    }
+}}
+
+namespace niji
+{
+    // Transforms the nodes of a container path (e.g. niji::path) in place.
+    // For flat_path, f must support transform_n as transforms::affine does.
+    template<class Path, class F>
+    inline void transform_in_place(Path& path, F const& f)
+    {
+        detail::transform_in_place_dispatch(detail::priority<1>{}, path, f);
+    }
+}
+
+#endif
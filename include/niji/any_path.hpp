@@ -11,6 +11,7 @@
 #include <functional>
 #include <niji/render.hpp>
 #include <niji/sink/any.hpp>
+#include <niji/support/batch.hpp>
 
 namespace niji
 {
@@ -24,12 +25,16 @@ namespace niji
         {
             Path path;
             
+            // The commands are passed in batches to save the indirect calls.
             void operator()(sink_t& sink, bool positive) const
             {
-                if (positive)
-                    niji::render(path, sink);
-                else
-                    niji::inverse_render(path, sink);
+                detail::batch_render<Point>(sink, [&](auto& sink)
+                {
+                    if (positive)
+                        niji::render(path, sink);
+                    else
+                        niji::inverse_render(path, sink);
+                });
             }
         };
         
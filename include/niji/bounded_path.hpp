@@ -0,0 +1,141 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+#ifndef NIJI_BOUNDED_PATH_HPP_INCLUDED
+#define NIJI_BOUNDED_PATH_HPP_INCLUDED
+
+#include <mutex>
+#include <atomic>
+#include <utility>
+#include <type_traits>
+#include <niji/render.hpp>
+#include <niji/support/box.hpp>
+#include <niji/support/point.hpp>
+#include <niji/algorithm/bounds.hpp>
+
+namespace niji
+{
+    // Caches the tight & the control bounds of the path, computed on demand,
+    // so niji::bounds & niji::control_bounds are O(1) until it's modified,
+    // e.g. `make_bounded(path)`.
+    //
+    // The bounds may be queried concurrently, modifying the path is not
+    // synchronized though.
+    template<class Path>
+    class bounded_path
+    {
+        using coord_t = path_coordinate_t<std::decay_t<Path>>;
+        using box_t = box<point<coord_t>>;
+
+    public:
+
+        using point_type = path_point_t<std::decay_t<Path>>;
+
+        explicit bounded_path(Path path)
+          : _path(std::forward<Path>(path)), _state(0)
+        {}
+
+        bounded_path(bounded_path const& other)
+          : _path(other._path), _tight(other._tight), _control(other._control)
+          , _state(other._state.load(std::memory_order_acquire))
+        {}
+
+        bounded_path(bounded_path&& other)
+          : _path(std::forward<Path>(other._path)), _tight(other._tight), _control(other._control)
+          , _state(other._state.load(std::memory_order_acquire))
+        {
+            other.invalidate();
+        }
+
+        template<class Sink>
+        void render(Sink& sink) const
+        {
+            niji::render(_path, sink);
+        }
+
+        template<class Sink>
+        void inverse_render(Sink& sink) const
+        {
+            niji::inverse_render(_path, sink);
+        }
+
+        box_t const& bounds() const
+        {
+            return get(tight_bit, _tight, [this]
+            {
+                detail::bounds_sink<coord_t> sink;
+                niji::render(_path, sink);
+                return box_t(sink.min, sink.max);
+            });
+        }
+
+        // The box of all the points including the control points.
+        box_t const& control_bounds() const
+        {
+            return get(control_bit, _control, [this]
+            {
+                detail::control_bounds_sink<coord_t> sink;
+                niji::render(_path, sink);
+                return box_t(sink.min, sink.max);
+            });
+        }
+
+        // Modifies the path by `f(path)`, the bounds are invalidated.
+        template<class F>
+        void modify(F&& f)
+        {
+            invalidate();
+            std::forward<F>(f)(_path);
+        }
+
+        void invalidate()
+        {
+            _state.store(0, std::memory_order_relaxed);
+        }
+
+        Path const& upstream() const
+        {
+            return _path;
+        }
+
+    private:
+
+        enum : unsigned char
+        {
+            control_bit = 1,
+            tight_bit = 2
+        };
+
+        // Double-checked, the box is written before its bit is published.
+        template<class F>
+        box_t const& get(unsigned char bit, box_t& b, F&& compute) const
+        {
+            if (!(_state.load(std::memory_order_acquire) & bit))
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (!(_state.load(std::memory_order_relaxed) & bit))
+                {
+                    b = compute();
+                    _state.fetch_or(bit, std::memory_order_release);
+                }
+            }
+            return b;
+        }
+
+        Path _path;
+        mutable box_t _tight, _control;
+        mutable std::atomic<unsigned char> _state;
+        mutable std::mutex _mutex;
+    };
+
+    template<class Path>
+    inline bounded_path<Path> make_bounded(Path&& path)
+    {
+        return bounded_path<Path>{std::forward<Path>(path)};
+    }
+}
+
+#endif
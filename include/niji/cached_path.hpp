@@ -0,0 +1,147 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+#ifndef NIJI_CACHED_PATH_HPP_INCLUDED
+#define NIJI_CACHED_PATH_HPP_INCLUDED
+
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+#include <niji/render.hpp>
+#include <niji/sink/recording.hpp>
+
+namespace niji
+{
+    // Records the output of the path the first time it's rendered and
+    // replays the recording afterwards, e.g. `make_cached(path | views...)`.
+    // It's invalidated either explicitly or when the key is changed.
+    //
+    // It may be rendered concurrently, invalidating it is not synchronized
+    // though.
+    template<class Path, class Key = std::size_t>
+    class cached_path
+    {
+        using recording_t = recording_sink<path_point_t<std::decay_t<Path>>>;
+
+    public:
+
+        using point_type = path_point_t<std::decay_t<Path>>;
+
+        explicit cached_path(Path path, Key key = Key())
+          : _path(std::forward<Path>(path)), _key(std::move(key)), _state(0)
+        {}
+
+        cached_path(cached_path const& other)
+          : _path(other._path), _key(other._key)
+          , _recording(other._recording), _inverse_recording(other._inverse_recording)
+          , _state(other._state.load(std::memory_order_acquire))
+        {}
+
+        cached_path(cached_path&& other)
+          : _path(std::forward<Path>(other._path)), _key(std::move(other._key))
+          , _recording(std::move(other._recording)), _inverse_recording(std::move(other._inverse_recording))
+          , _state(other._state.load(std::memory_order_acquire))
+        {
+            other.invalidate();
+        }
+
+        template<class Sink>
+        void render(Sink& sink) const
+        {
+            niji::render(get(recorded_bit, _recording, [this](recording_t& recording)
+            {
+                niji::render(_path, recording);
+            }), sink);
+        }
+
+        template<class Sink>
+        void inverse_render(Sink& sink) const
+        {
+            niji::render(get(inverse_recorded_bit, _inverse_recording, [this](recording_t& recording)
+            {
+                niji::inverse_render(_path, recording);
+            }), sink);
+        }
+
+        // The recordings are kept for reuse of the capacity.
+        void invalidate()
+        {
+            _state.store(0, std::memory_order_relaxed);
+        }
+
+        // Invalidates if the key is different, returns true if so.
+        bool rekey(Key const& key)
+        {
+            if (_key == key)
+                return false;
+            _key = key;
+            invalidate();
+            return true;
+        }
+
+        Key const& key() const
+        {
+            return _key;
+        }
+
+        bool is_cached() const
+        {
+            return _state.load(std::memory_order_acquire) & recorded_bit;
+        }
+
+        Path const& upstream() const
+        {
+            return _path;
+        }
+
+    private:
+
+        enum : unsigned char
+        {
+            recorded_bit = 1,
+            inverse_recorded_bit = 2
+        };
+
+        // Double-checked, the recording is made before its bit is published.
+        template<class F>
+        recording_t const& get(unsigned char bit, recording_t& recording, F&& record) const
+        {
+            if (!(_state.load(std::memory_order_acquire) & bit))
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (!(_state.load(std::memory_order_relaxed) & bit))
+                {
+                    recording.clear();
+                    record(recording);
+                    _state.fetch_or(bit, std::memory_order_release);
+                }
+            }
+            return recording;
+        }
+
+        Path _path;
+        Key _key;
+        mutable recording_t _recording, _inverse_recording;
+        mutable std::atomic<unsigned char> _state;
+        mutable std::mutex _mutex;
+    };
+
+    template<class Path>
+    inline cached_path<Path> make_cached(Path&& path)
+    {
+        return cached_path<Path>{std::forward<Path>(path)};
+    }
+
+    template<class Key, class Path>
+    inline cached_path<Path, std::decay_t<Key>> make_cached(Path&& path, Key&& key)
+    {
+        return cached_path<Path, std::decay_t<Key>>{std::forward<Path>(path), std::forward<Key>(key)};
+    }
+}
+
+#endif
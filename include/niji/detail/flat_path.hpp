@@ -0,0 +1,86 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+#ifndef NIJI_DETAIL_FLAT_PATH_HPP_INCLUDED
+#define NIJI_DETAIL_FLAT_PATH_HPP_INCLUDED
+
+#include <cstddef>
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/geometry/algorithms/make.hpp>
+#include <boost/geometry/core/coordinate_type.hpp>
+
+namespace niji { namespace detail
+{
+    template<class F>
+    using flat_path_result_coord_t = typename
+        boost::geometry::coordinate_type<typename F::result_type>::type;
+
+    // Zips the separate x & y arrays, the node is made on dereference.
+    template<class Node, class CoordIt>
+    struct soa_iterator
+      : boost::iterator_facade
+        <
+            soa_iterator<Node, CoordIt>
+          , Node
+          , boost::random_access_traversal_tag
+          , Node
+        >
+    {
+        soa_iterator() = default;
+
+        soa_iterator(CoordIt const& x, CoordIt const& y)
+          : _x(x), _y(y)
+        {}
+
+        CoordIt x() const
+        {
+            return _x;
+        }
+
+        CoordIt y() const
+        {
+            return _y;
+        }
+
+    private:
+
+        friend class boost::iterator_core_access;
+
+        Node dereference() const
+        {
+            return boost::geometry::make<Node>(*_x, *_y);
+        }
+
+        bool equal(soa_iterator const& other) const
+        {
+            return _x == other._x;
+        }
+
+        void increment()
+        {
+            ++_x, ++_y;
+        }
+
+        void decrement()
+        {
+            --_x, --_y;
+        }
+
+        void advance(std::ptrdiff_t n)
+        {
+            _x += n, _y += n;
+        }
+
+        std::ptrdiff_t distance_to(soa_iterator const& other) const
+        {
+            return other._x - _x;
+        }
+
+        CoordIt _x, _y;
+    };
+}}
+
+#endif
@@ -8,130 +8,16 @@
 #define NIJI_DETAIL_PATH_HPP_INCLUDED
 
 #include <boost/iterator/iterator_facade.hpp>
+#include <boost/range/iterator_range_core.hpp>
 #include <boost/geometry/core/coordinate_type.hpp>
-#include <boost/range/adaptor/reversed.hpp>
-#include <boost/range/adaptor/transformed.hpp>
 #include <niji/render.hpp>
 #include <niji/support/command.hpp>
 #include <niji/support/vector.hpp>
 #include <niji/support/point.hpp>
+#include <niji/detail/verb.hpp>
 
 namespace niji { namespace detail
 {
-    struct index_tag_t
-    {
-        std::size_t index;
-        char tag;
-        
-        index_tag_t() = default; // for serialization
-
-        index_tag_t(std::size_t index, char tag)
-          : index(index), tag(tag)
-        {}
-        
-        bool is_end_tag() const
-        {
-            return !(tag >> 1);
-        }
-
-        template<class Archive>
-        void serialize(Archive & ar, unsigned version)
-        {
-            ar & index & tag;
-        }
-
-        static auto remap(std::size_t max, char& end)
-        {
-            return [max, &end](index_tag_t ret)
-            {
-                ret.index = max - ret.index;
-                if (ret.is_end_tag())
-                    std::swap(ret.tag, end);
-                else // curve-tag
-                    ret.index -= 1 + (ret.tag == 3);
-                return ret;
-            };
-        }
-
-        static auto remap_no_end(std::size_t max)
-        {
-            return [max](index_tag_t ret)
-            {
-                ret.index = max - (ret.index + 1 + (ret.tag == 3));
-                return ret;
-            };
-        }
-    };
-    
-    inline auto index_tag_is_end()
-    {
-        return [](index_tag_t const& a)
-        {
-            return a.is_end_tag();
-        };
-    }
-
-    template<class Sink, class Nodes, class IndexTags>
-    bool path_render_impl
-    (
-        Sink& sink
-      , Nodes const& nodes
-      , IndexTags const& index_tags
-      , bool heading = true
-    )
-    {
-        using namespace command;
-
-        auto it(nodes.begin()), end(nodes.end());
-        for (auto const& i : index_tags)
-        {
-            auto tagged(nodes.begin() + i.index);
-            if (it != tagged)
-            {
-                if (heading)
-                    sink(move_to, *it);
-                else
-                    sink(line_to, *it);
-                while (++it != tagged)
-                    sink(line_to, *it);
-            }
-            else if (heading)
-                continue;
-            switch (i.tag)
-            {
-            case end_tag::closed:
-                sink(end_closed);
-                heading = true;
-                break;
-            case end_tag::open:
-                sink(end_open);
-                heading = true;
-                break;
-            case 2:
-                sink(quad_to, *it, *(it + 1));
-                it += 2;
-                heading = false;
-                break;
-            case 3:
-                sink(cubic_to, *it, *(it + 1), *(it + 2));
-                it += 3;
-                heading = false;
-                break;
-            }
-        }
-        if (it != end)
-        {
-            if (heading)
-                sink(move_to, *it);
-            else
-                sink(line_to, *it);
-            while (++it != end)
-                sink(line_to, *it);
-            return true; // needs ending
-        }
-        return !heading; // ended
-    }
-
     template<class NodeIt>
     bool path_is_box(NodeIt it, NodeIt const& end)
     {
@@ -162,7 +48,7 @@ namespace niji { namespace detail
         return p[i] == c[i];
     }
     
-    template<class NodeIt, class IndexIt>
+    template<class NodeIt, class VerbIt>
     struct pathlet
     {
         using point_type = typename NodeIt::value_type;
@@ -171,14 +57,14 @@ namespace niji { namespace detail
 
         pathlet() = default;
 
-        pathlet(NodeIt const& begin, NodeIt const& end, IndexIt const& tit, IndexIt const& tend, std::size_t offset)
-          : _begin(begin), _end(end), _index_tags(tit, tend)
-          , _offset(offset)
+        // The verbs start with move and include the end verb if any.
+        pathlet(NodeIt const& begin, NodeIt const& end, VerbIt const& vbegin, VerbIt const& vend)
+          : _begin(begin), _end(end), _verbs(vbegin, vend)
         {}
 
         iterator begin() const
         {
-            return _begin + (_offset >> 1);
+            return _begin;
         }
 
         iterator end() const
@@ -188,12 +74,12 @@ namespace niji { namespace detail
 
         bool empty() const
         {
-            return begin() == _end;
+            return _begin == _end;
         }
 
         bool is_closed() const
         {
-            return _offset & 1;
+            return !_verbs.empty() && _verbs.back() == verb::closed;
         }
 
         bool is_box() const
@@ -204,67 +90,30 @@ namespace niji { namespace detail
         template<class Sink>
         void render(Sink& sink) const
         {
-            render_impl(sink, _begin, begin(), _end, _index_tags, is_closed());
+            if (verb_render_impl(sink, _verbs.begin(), _verbs.end(), _begin))
+                sink(command::end_open);
         }
         
         template<class Sink>
         void inverse_render(Sink& sink) const
         {
-            namespace rng = ::boost::adaptors;
-            
-            boost::reverse_iterator<NodeIt> it(_end), end(begin());
-            render_impl(sink, it, it, end, rng::transform(rng::reverse(_index_tags),
-                index_tag_t::remap_no_end(_end - _begin)), is_closed());
+            verb_inverse_render_impl(sink, _verbs.begin(), _verbs.end(), _end);
         }
 
     private:
-        
-        template<class Sink, class It, class IndexTags>
-        static void render_impl(Sink& sink, It origin, It it, It end, IndexTags const& index_tags, bool is_closed)
-        {
-            using namespace command;
-
-            if (it == end)
-                return;
-            sink(move_to, *it++);
-            for (auto const& i : index_tags)
-            {
-                auto tagged(origin + i.index);
-                for ( ; it != tagged; ++it)
-                    sink(line_to, *it);
-                switch (i.tag)
-                {
-                case 2:
-                    sink(quad_to, *it, *(it + 1));
-                    it += 2;
-                    break;
-                case 3:
-                    sink(cubic_to, *it, *(it + 1), *(it + 2));
-                    it += 3;
-                    break;
-                }
-            }
-            for ( ; it != end; ++it)
-                sink(line_to, *it);
-            if (is_closed)
-                sink(end_closed);
-            else
-                sink(end_open);
-        }
 
         NodeIt _begin, _end;
-        boost::iterator_range<IndexIt> _index_tags;
-        std::size_t _offset;
+        boost::iterator_range<VerbIt> _verbs;
     };
 
-    template<class NodeIt, class IndexIt>
+    template<class NodeIt, class VerbIt>
     struct path_partition
     {
-        using value_type = pathlet<NodeIt, IndexIt>;
+        using value_type = pathlet<NodeIt, VerbIt>;
         using reference = value_type;
         
-        path_partition(NodeIt const& begin, NodeIt const& end, IndexIt const& tbegin, IndexIt const& tend)
-          : _begin(begin), _end(end), _tbegin(tbegin), _tend(tend)
+        path_partition(NodeIt const& begin, VerbIt const& vbegin, VerbIt const& vend)
+          : _begin(begin), _vbegin(vbegin), _vend(vend)
         {}
 
         struct iterator
@@ -278,87 +127,93 @@ namespace niji { namespace detail
         {
             iterator() {}
 
-            iterator(path_partition const* rng, IndexIt const& tit)
-              : _rng(rng)
-              , _tit(std::find_if(tit, rng->_tend, index_tag_is_end()))
-              , _tlast(tit), _it(_tit == rng->_tend? _rng->_end : _rng->_begin + _tit->index)
-            {}
+            iterator(NodeIt const& it, VerbIt const& vit, VerbIt const& vend)
+              : _vend(vend), _vit(vit), _vnext(vit), _it(it), _next(it)
+            {
+                seek();
+            }
 
             void increment()
             {
-                _tlast = _tit;
-                IndexIt tend(_rng->_tend);
-                if (_tit == tend)
-                {
-                    _it = {};
-                    return;
-                }
-                _tit = std::find_if(++_tit, tend, index_tag_is_end());
-                _it = _tit == tend? _rng->_end : _rng->_begin + _tit->index;
+                _vit = _vnext;
+                _it = _next;
+                seek();
             }
 
             bool equal(iterator const& other) const
             {
-                return _it == other._it;
+                return _vit == other._vit;
             }
             
             reference dereference() const
             {
-                std::size_t offset = 0;
-                auto tlast = _tlast;
-                if (tlast != _tit && tlast->is_end_tag())
-                {
-                    offset = tlast->index << 1;
-                    ++tlast;
-                }
-                offset |= _tit != _rng->_tend && !_tit->tag;
-                return {_rng->_begin, _it, tlast, _tit, offset};
+                return {_it, _next, _vit, _vnext};
             }
 
         private:
 
-            path_partition const* _rng;
-            IndexIt _tit, _tlast;
-            NodeIt _it;
+            // Finds the end of the figure, which is past the end verb or
+            // right before the next move.
+            void seek()
+            {
+                if (_vnext == _vend)
+                    return;
+                _next += verb::nodes(*_vnext);
+                while (++_vnext != _vend)
+                {
+                    char v = *_vnext;
+                    if (v == verb::move)
+                        break;
+                    if (verb::is_end(v))
+                    {
+                        ++_vnext;
+                        break;
+                    }
+                    _next += verb::nodes(v);
+                }
+            }
+
+            VerbIt _vend, _vit, _vnext;
+            NodeIt _it, _next;
         };
 
         using const_iterator = iterator;
 
         iterator begin() const
         {
-            return {this, _tbegin};
+            return {_begin, _vbegin, _vend};
         }
 
         iterator end() const
         {
-            return {};
+            return {_begin, _vend, _vend};
         }
 
     private:
 
-        NodeIt const _begin, _end;
-        IndexIt const _tbegin, _tend;
+        NodeIt const _begin;
+        VerbIt const _vbegin, _vend;
     };
 
-    template<class NodeIt, class IndexIt>
+    template<class NodeIt, class VerbIt>
     struct incomplete_path
     {
         using point_type = typename NodeIt::value_type;
 
-        incomplete_path(NodeIt const& begin, NodeIt const& end, IndexIt const& tbegin, IndexIt const& tend)
-          : _nodes(begin, end), _index_tags(tbegin, tend)
+        incomplete_path(NodeIt const& begin, NodeIt const& end, VerbIt const& vbegin, VerbIt const& vend)
+          : _nodes(begin, end), _verbs(vbegin, vend)
         {}
 
         template<class Sink>
         void render(Sink& sink) const
         {
-            path_render_impl(sink, _nodes, _index_tags, false);
+            verb_render_impl(sink, _verbs.begin(), _verbs.end(), _nodes.begin(), false);
         }
 
     private:
 
         boost::iterator_range<NodeIt> _nodes;
-        boost::iterator_range<IndexIt> _index_tags;
+        boost::iterator_range<VerbIt> _verbs;
     };
 }}
 
@@ -0,0 +1,231 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+#ifndef NIJI_DETAIL_VERB_HPP_INCLUDED
+#define NIJI_DETAIL_VERB_HPP_INCLUDED
+
+#include <cstddef>
+#include <iterator>
+#include <niji/support/command.hpp>
+
+namespace niji { namespace detail { namespace verb
+{
+    // the order is intentional, the end verbs share the values of end_tag.
+    enum type : char
+    {
+        closed = end_tag::closed,
+        open = end_tag::open,
+        quad,
+        cubic,
+        move,
+        line
+    };
+
+    // Number of nodes consumed by each verb, the node positions are implied
+    // by the verbs so that there's no index stored.
+    inline unsigned nodes(char v)
+    {
+        static constexpr unsigned char table[] = {0, 0, 2, 3, 1, 1};
+        return table[static_cast<unsigned char>(v)];
+    }
+
+    inline bool is_end(char v)
+    {
+        return !(v >> 1);
+    }
+
+    template<class Verbs>
+    inline bool is_ended(Verbs const& verbs)
+    {
+        return verbs.empty() || is_end(verbs.back());
+    }
+
+    // Whether the verbs are valid and consume exactly `np` nodes, each figure
+    // starting with a move, so that the traversals stay within the nodes.
+    template<class VerbIt>
+    inline bool check(VerbIt it, VerbIt const& end, std::size_t np)
+    {
+        std::size_t n = 0;
+        bool heading = true;
+        for ( ; it != end; ++it)
+        {
+            char const v = *it;
+            if (static_cast<unsigned char>(v) > line || (heading && v != move))
+                return false;
+            n += nodes(v);
+            heading = is_end(v);
+        }
+        return n == np;
+    }
+}}}
+
+namespace niji { namespace detail
+{
+    // Returns true if the last figure is not ended.
+    // If not heading, the leading move is rendered as line_to, which continues
+    // the current figure of the sink.
+    template<class Sink, class VerbIt, class NodeIt>
+    bool verb_render_impl(Sink& sink, VerbIt vit, VerbIt const& vend, NodeIt it, bool heading = true)
+    {
+        using namespace command;
+
+        bool needs_ending = false;
+        if (!heading && vit != vend && *vit == verb::move)
+        {
+            sink(line_to, *it);
+            ++it, ++vit;
+            needs_ending = true;
+        }
+        for ( ; vit != vend; ++vit)
+        {
+            switch (*vit)
+            {
+            case verb::closed:
+                sink(end_closed);
+                needs_ending = false;
+                break;
+            case verb::open:
+                sink(end_open);
+                needs_ending = false;
+                break;
+            case verb::quad:
+            {
+                auto&& pt1 = *it;
+                auto&& pt2 = *++it;
+                sink(quad_to, pt1, pt2);
+                ++it;
+                break;
+            }
+            case verb::cubic:
+            {
+                auto&& pt1 = *it;
+                auto&& pt2 = *++it;
+                auto&& pt3 = *++it;
+                sink(cubic_to, pt1, pt2, pt3);
+                ++it;
+                break;
+            }
+            case verb::move:
+                sink(move_to, *it);
+                ++it;
+                needs_ending = true;
+                break;
+            case verb::line:
+                sink(line_to, *it);
+                ++it;
+                break;
+            }
+        }
+        return needs_ending;
+    }
+
+    // Renders the figures in reverse order, each with its nodes reversed.
+    // A figure keeps its own end tag, an unended figure is rendered as open.
+    // This is a linear scan backward, `nend` is the end of the nodes.
+    template<class Sink, class VerbIt, class NodeIt>
+    void verb_inverse_render_impl(Sink& sink, VerbIt const& vbegin, VerbIt const& vend, NodeIt const& nend)
+    {
+        using namespace command;
+
+        std::reverse_iterator<VerbIt> vit(vend), vrend(vbegin);
+        std::reverse_iterator<NodeIt> it(nend);
+        while (vit != vrend)
+        {
+            char tag = verb::open;
+            if (verb::is_end(*vit))
+            {
+                tag = *vit;
+                if (++vit == vrend)
+                    break;
+            }
+            sink(move_to, *it);
+            for (bool heading = true; heading; ++vit)
+            {
+                switch (*vit)
+                {
+                case verb::quad:
+                {
+                    auto&& pt1 = *++it;
+                    auto&& pt2 = *++it;
+                    sink(quad_to, pt1, pt2);
+                    break;
+                }
+                case verb::cubic:
+                {
+                    auto&& pt1 = *++it;
+                    auto&& pt2 = *++it;
+                    auto&& pt3 = *++it;
+                    sink(cubic_to, pt1, pt2, pt3);
+                    break;
+                }
+                case verb::line:
+                    ++it;
+                    sink(line_to, *it);
+                    break;
+                default: // move
+                    ++it;
+                    heading = false;
+                }
+            }
+            if (tag == verb::closed)
+                sink(end_closed);
+            else
+                sink(end_open);
+        }
+    }
+
+    // Appends the verbs of another path. If the receiving path is not ended,
+    // the leading move is demoted to line, i.e. the figure is continued.
+    template<class Verbs, class VerbIt>
+    void verb_splice(Verbs& verbs, VerbIt it, VerbIt const& end)
+    {
+        if (it == end)
+            return;
+        verbs.reserve(verbs.size() + std::distance(it, end));
+        if (!verb::is_ended(verbs) && *it == verb::move)
+        {
+            verbs.push_back(verb::line);
+            ++it;
+        }
+        verbs.insert(verbs.end(), it, end);
+    }
+
+    // Appends the verbs of another path in reverse, to be paired with the
+    // nodes appended in reverse order. This is the counterpart of
+    // verb_inverse_render_impl, except that an unended figure stays unended
+    // if it's the last one, and the leading move is demoted to line if the
+    // receiving path is not ended.
+    template<class Verbs, class VerbIt>
+    void verb_reverse_splice(Verbs& verbs, VerbIt const& begin, VerbIt const& end)
+    {
+        if (begin == end)
+            return;
+        verbs.reserve(verbs.size() + std::distance(begin, end) + 1);
+        char lead = verb::is_ended(verbs) ? verb::move : verb::line;
+        auto it = end;
+        while (it != begin)
+        {
+            char tag = verb::open;
+            bool has_end = verb::is_end(*--it);
+            if (has_end)
+            {
+                tag = *it;
+                if (it == begin)
+                    break;
+            }
+            else
+                ++it;
+            verbs.push_back(lead);
+            lead = verb::move;
+            for (char v; (v = *--it) != verb::move; )
+                verbs.push_back(v);
+            if (has_end || it != begin)
+                verbs.push_back(tag);
+        }
+    }
+}}
+
+#endif
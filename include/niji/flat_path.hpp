@@ -0,0 +1,444 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+#ifndef NIJI_FLAT_PATH_HPP_INCLUDED
+#define NIJI_FLAT_PATH_HPP_INCLUDED
+
+#include <initializer_list>
+#include <boost/assert.hpp>
+#include <boost/container/vector.hpp>
+#include <boost/container/allocator_traits.hpp>
+#include <boost/geometry/core/access.hpp>
+#include <boost/geometry/core/coordinate_type.hpp>
+#include <niji/path_fwd.hpp>
+#include <niji/render.hpp>
+#include <niji/detail/path.hpp>
+#include <niji/detail/verb.hpp>
+#include <niji/support/batch.hpp>
+#include <niji/detail/flat_path.hpp>
+
+namespace niji
+{
+    // A drop-in replacement of niji::path with contiguous storage.
+    // The coordinates are kept in separate x & y arrays (structure of arrays),
+    // and the commands are packed in a verb stream of 1 byte per verb.
+    template<class Node, class Alloc>
+    class flat_path
+    {
+        template<class N, class A>
+        friend class flat_path;
+
+        using coord_t = typename boost::geometry::coordinate_type<Node>::type;
+        using coord_alloc_t =
+            typename boost::container::allocator_traits<Alloc>::template
+                portable_rebind_alloc<coord_t>::type;
+        using verb_alloc_t =
+            typename boost::container::allocator_traits<Alloc>::template
+                portable_rebind_alloc<char>::type;
+        using coord_container = boost::container::vector<coord_t, coord_alloc_t>;
+        using verb_container = boost::container::vector<char, verb_alloc_t>;
+
+    public:
+
+        using point_type = Node;
+        using coordinate_type = coord_t;
+
+        // Iterators
+        //----------------------------------------------------------------------
+        using const_iterator = detail::soa_iterator<Node, coord_t const*>;
+        using iterator = const_iterator;
+
+        const_iterator begin() const
+        {
+            return {_xs.data(), _ys.data()};
+        }
+
+        const_iterator end() const
+        {
+            return {_xs.data() + _xs.size(), _ys.data() + _ys.size()};
+        }
+
+        // Observers
+        //----------------------------------------------------------------------
+        Node front() const
+        {
+            return boost::geometry::make<Node>(_xs.front(), _ys.front());
+        }
+
+        Node back() const
+        {
+            return boost::geometry::make<Node>(_xs.back(), _ys.back());
+        }
+
+        std::size_t size() const
+        {
+            return _xs.size();
+        }
+
+        bool empty() const
+        {
+            return _xs.empty();
+        }
+
+        coord_t const* xs() const
+        {
+            return _xs.data();
+        }
+
+        coord_t const* ys() const
+        {
+            return _ys.data();
+        }
+
+        coord_t* xs()
+        {
+            return _xs.data();
+        }
+
+        coord_t* ys()
+        {
+            return _ys.data();
+        }
+
+        bool is_box() const
+        {
+            return detail::path_is_box(begin(), end());
+        }
+
+        bool is_ended() const
+        {
+            return detail::verb::is_ended(_verbs);
+        }
+
+        struct sink
+        {
+            explicit sink(flat_path& own, bool moving = true)
+              : _own(own), _moving(moving)
+            {}
+
+            // silent MSVC warning C4512
+            sink& operator=(sink const&) = delete;
+
+            void operator()(move_to_t, Node const& pt)
+            {
+                _prev = pt;
+                _moving = true;
+            }
+
+            void operator()(line_to_t, Node const& pt)
+            {
+                line_start();
+                _own.join(pt);
+            }
+
+            void operator()(quad_to_t, Node const& pt1, Node const& pt2)
+            {
+                line_start();
+                _own.unsafe_quad_to(pt1, pt2);
+            }
+
+            void operator()(cubic_to_t, Node const& pt1, Node const& pt2, Node const& pt3)
+            {
+                line_start();
+                _own.unsafe_cubic_to(pt1, pt2, pt3);
+            }
+
+            void operator()(end_tag tag)
+            {
+                _own.delimit(tag);
+                _moving = true;
+            }
+
+        private:
+
+            void line_start()
+            {
+                if (_moving)
+                {
+                    _own.cut();
+                    _own.join(_prev);
+                    _moving = false;
+                }
+            }
+
+            flat_path& _own;
+            Node _prev;
+            bool _moving;
+        };
+
+        template<class Path>
+        using requires_valid =
+            std::enable_if_t<is_renderable<Path, sink>::value, bool>;
+
+        // Constructors
+        //----------------------------------------------------------------------
+        flat_path() = default;
+
+        explicit flat_path(Alloc const& alloc) noexcept
+          : _xs(alloc), _ys(alloc), _verbs(alloc)
+        {}
+
+        flat_path(flat_path const& other, Alloc const& alloc)
+          : _xs(other._xs, alloc)
+          , _ys(other._ys, alloc)
+          , _verbs(other._verbs, alloc)
+        {}
+
+        flat_path(flat_path&& other, Alloc const& alloc) noexcept
+          : _xs(std::move(other._xs), alloc)
+          , _ys(std::move(other._ys), alloc)
+          , _verbs(std::move(other._verbs), alloc)
+        {}
+
+        template<class Path, requires_valid<Path> = true>
+        flat_path(Path const& other, Alloc const& alloc = Alloc())
+          : _xs(alloc), _ys(alloc), _verbs(alloc)
+        {
+            add(other);
+        }
+
+        template<class Iter>
+        flat_path(Iter const& begin, Iter const& end, Alloc const& alloc = Alloc())
+          : _xs(alloc), _ys(alloc), _verbs(alloc)
+        {
+            join(begin, end);
+        }
+
+        flat_path(std::initializer_list<Node> pts, Alloc const& alloc = Alloc())
+          : _xs(alloc), _ys(alloc), _verbs(alloc)
+        {
+            join(pts.begin(), pts.end());
+        }
+
+        template<class Path>
+        flat_path& operator=(Path const& other)
+        {
+            clear();
+            add(other);
+            return *this;
+        }
+
+        // Path Traversal
+        //----------------------------------------------------------------------
+        template<class Sink>
+        void render(Sink& sink) const
+        {
+            detail::batch_render<Node>(sink, [this](auto& sink)
+            {
+                if (detail::verb_render_impl(sink, _verbs.begin(), _verbs.end(), begin()))
+                    sink(command::end_open);
+            });
+        }
+
+        template<class Sink>
+        void inverse_render(Sink& sink) const
+        {
+            detail::batch_render<Node>(sink, [this](auto& sink)
+            {
+                detail::verb_inverse_render_impl(sink, _verbs.begin(), _verbs.end(), end());
+            });
+        }
+
+        // Renders the nodes mapped by f, which transforms the coordinates in
+        // bulk (see transforms::affine::transform_n), a chunk at a time.
+        template<class Sink, class F, class U = detail::flat_path_result_coord_t<F>>
+        auto render_transformed(Sink& sink, F const& f) const ->
+            decltype(f.transform_n(xs(), ys(), size(), (U*)nullptr, (U*)nullptr))
+        {
+            using result_t = typename F::result_type;
+            using result_coord_t = U;
+            using iterator_t = detail::soa_iterator<result_t, result_coord_t const*>;
+            constexpr std::size_t chunk = 256;
+
+            result_coord_t bx[chunk], by[chunk];
+            std::size_t i = 0;
+            auto vit = _verbs.begin(), vend = _verbs.end();
+            while (vit != vend)
+            {
+                auto vbegin = vit;
+                std::size_t n = 0;
+                for ( ; vit != vend; ++vit)
+                {
+                    auto k = detail::verb::nodes(*vit);
+                    if (n + k > chunk)
+                        break;
+                    n += k;
+                }
+                f.transform_n(_xs.data() + i, _ys.data() + i, n, bx, by);
+                detail::verb_render_impl(sink, vbegin, vit, iterator_t(bx, by));
+                i += n;
+            }
+            if (!is_ended())
+                sink(command::end_open);
+        }
+
+        // Modofiers
+        //----------------------------------------------------------------------
+        void join(Node const& v)
+        {
+            _verbs.push_back(is_ended() ? detail::verb::move : detail::verb::line);
+            push_node(v);
+        }
+
+        template<class Iter>
+        void join(Iter begin, Iter const& end)
+        {
+            auto n = std::distance(begin, end);
+            if (!n)
+                return;
+            reserve(size() + n, _verbs.size() + n);
+            join(*begin);
+            while (++begin != end)
+            {
+                _verbs.push_back(detail::verb::line);
+                push_node(*begin);
+            }
+        }
+
+        void join_quad(Node const& pt1, Node const& pt2, Node const& pt3)
+        {
+            join(pt1);
+            unsafe_quad_to(pt2, pt3);
+        }
+
+        void join_cubic(Node const& pt1, Node const& pt2, Node const& pt3, Node const& pt4)
+        {
+            join(pt1);
+            unsafe_cubic_to(pt2, pt3, pt4);
+        }
+
+        template<class Nodes = std::initializer_list<Node>>
+        void join_sequence(Nodes const& pts)
+        {
+            join(pts.begin(), pts.end());
+        }
+
+        // This is useful for paths that don't start with move_to, in which
+        // case results in continuous path.
+        template<class Path>
+        void join_path(Path const& p)
+        {
+            niji::render(p, sink(*this, is_ended()));
+        }
+
+        // niji::flat_path always starts with move_to.
+        template<class Point, class A>
+        void join_path(flat_path<Point, A> const& p)
+        {
+            cut();
+            splice(p);
+        }
+
+        template<class Path>
+        auto add(Path const& p)
+        {
+            niji::render(p, sink(*this, true));
+        }
+
+        template<class Point, class A>
+        void add(flat_path<Point, A> const& p)
+        {
+            join_path(p);
+        }
+
+        template<class Point, class A>
+        void splice(flat_path<Point, A> const& p)
+        {
+            detail::verb_splice(_verbs, p._verbs.begin(), p._verbs.end());
+            _xs.insert(_xs.end(), p._xs.begin(), p._xs.end());
+            _ys.insert(_ys.end(), p._ys.begin(), p._ys.end());
+        }
+
+        template<class Point, class A>
+        void reverse_splice(flat_path<Point, A> const& p)
+        {
+            detail::verb_reverse_splice(_verbs, p._verbs.begin(), p._verbs.end());
+            _xs.insert(_xs.end(), p._xs.rbegin(), p._xs.rend());
+            _ys.insert(_ys.end(), p._ys.rbegin(), p._ys.rend());
+        }
+
+        void unsafe_quad_to(Node const& pt1, Node const& pt2)
+        {
+            BOOST_ASSERT(!is_ended());
+            _verbs.push_back(detail::verb::quad);
+            push_node(pt1);
+            push_node(pt2);
+        }
+
+        void unsafe_cubic_to(Node const& pt1, Node const& pt2, Node const& pt3)
+        {
+            BOOST_ASSERT(!is_ended());
+            _verbs.push_back(detail::verb::cubic);
+            push_node(pt1);
+            push_node(pt2);
+            push_node(pt3);
+        }
+
+        void close()
+        {
+            delimit(end_tag::closed);
+        }
+
+        void cut()
+        {
+            delimit(end_tag::open);
+        }
+
+        void delimit(end_tag tag)
+        {
+            if (!is_ended())
+                _verbs.push_back(tag);
+        }
+
+        void reopen()
+        {
+            if (!_verbs.empty() && detail::verb::is_end(_verbs.back()))
+                _verbs.pop_back();
+        }
+
+        void reserve(std::size_t nodes, std::size_t verbs)
+        {
+            _xs.reserve(nodes);
+            _ys.reserve(nodes);
+            _verbs.reserve(verbs);
+        }
+
+        void clear() noexcept
+        {
+            _xs.clear();
+            _ys.clear();
+            _verbs.clear();
+        }
+
+        void swap(flat_path& other) noexcept
+        {
+            _xs.swap(other._xs);
+            _ys.swap(other._ys);
+            _verbs.swap(other._verbs);
+        }
+
+        template<class Archive>
+        void serialize(Archive& ar, unsigned version)
+        {
+            ar & _verbs & _xs & _ys;
+        }
+
+    private:
+
+        void push_node(Node const& pt)
+        {
+            using boost::geometry::get;
+
+            _xs.push_back(get<0>(pt));
+            _ys.push_back(get<1>(pt));
+        }
+
+        coord_container _xs, _ys;
+        verb_container _verbs;
+    };
+}
+
+#endif
@@ -0,0 +1,345 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+#ifndef NIJI_GRAPHIC_SVG_PATH_HPP_INCLUDED
+#define NIJI_GRAPHIC_SVG_PATH_HPP_INCLUDED
+
+#include <cmath>
+#include <charconv>
+#include <algorithm>
+#include <string_view>
+#include <system_error>
+#include <niji/support/command.hpp>
+#include <niji/support/point.hpp>
+#include <niji/support/vector.hpp>
+#include <niji/support/bezier.hpp>
+#include <niji/support/constants.hpp>
+#include <niji/support/transform/affine.hpp>
+
+namespace niji { namespace detail
+{
+    struct svg_scanner
+    {
+        char const* it;
+        char const* const end;
+
+        static bool is_space(char c)
+        {
+            return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\f';
+        }
+
+        static bool is_digit(char c)
+        {
+            return unsigned(c - '0') < 10;
+        }
+
+        void skip_space()
+        {
+            while (it != end && is_space(*it))
+                ++it;
+        }
+
+        // Skips the spaces with an optional comma.
+        void skip_separator()
+        {
+            skip_space();
+            if (it != end && *it == ',')
+            {
+                ++it;
+                skip_space();
+            }
+        }
+
+        bool at_number() const
+        {
+            if (it == end)
+                return false;
+            char c = *it;
+            return is_digit(c) || c == '.' || c == '-' || c == '+';
+        }
+
+        template<class T>
+        bool number(T& val)
+        {
+            if (!at_number())
+                return false;
+            char const* first = it;
+            if (*first == '+')
+                ++first;
+            // from_chars also accepts "inf" & "nan", which are not numbers here.
+            if (first == end || !(is_digit(*first) || *first == '.' ||
+                (*first == '-' && first + 1 != end && (is_digit(first[1]) || first[1] == '.'))))
+                return false;
+            auto ret = std::from_chars(first, end, val);
+            if (ret.ec != std::errc())
+                return false;
+            it = ret.ptr;
+            skip_separator();
+            return true;
+        }
+
+        template<class T>
+        bool point(niji::point<T>& pt)
+        {
+            return number(pt.x) && number(pt.y);
+        }
+
+        // The flags of arcs may not be separated, e.g. "a1 1 0 11 1 1".
+        bool flag(bool& val)
+        {
+            if (it == end || (*it != '0' && *it != '1'))
+                return false;
+            val = *it++ == '1';
+            skip_separator();
+            return true;
+        }
+    };
+
+    // The endpoint parameterization of SVG, converted to the center one, see
+    // https://www.w3.org/TR/SVG11/implnote.html#ArcImplementationNotes.
+    template<class T, class Sink>
+    void svg_arc(Sink& sink, point<T> const& pt0, T rx, T ry, T angle, bool large_arc, bool sweep, point<T> const& pt1)
+    {
+        using std::abs;
+        using std::sin;
+        using std::cos;
+        using std::sqrt;
+        using std::max;
+
+        if (pt0.x == pt1.x && pt0.y == pt1.y)
+            return;
+        rx = abs(rx), ry = abs(ry);
+        if (!rx || !ry)
+        {
+            sink(command::line_to, pt1);
+            return;
+        }
+        T const a = angle * constants::degree<T>(), sa = sin(a), ca = cos(a);
+        T const dx = (pt0.x - pt1.x) / 2, dy = (pt0.y - pt1.y) / 2;
+        T const x1 = ca * dx + sa * dy, y1 = ca * dy - sa * dx;
+        T const lambda = (x1 * x1) / (rx * rx) + (y1 * y1) / (ry * ry);
+        // The radii are scaled up if too small, the center is then the midpoint.
+        T coef = 0;
+        if (lambda >= 1)
+        {
+            T s = sqrt(lambda);
+            rx *= s, ry *= s;
+        }
+        else
+        {
+            T const rx2 = rx * rx, ry2 = ry * ry;
+            T const den = rx2 * y1 * y1 + ry2 * x1 * x1;
+            coef = sqrt(max((rx2 * ry2 - den) / den, T(0)));
+            if (large_arc == sweep)
+                coef = -coef;
+        }
+        T const cx1 = coef * rx * y1 / ry, cy1 = -coef * ry * x1 / rx;
+        T const cx = ca * cx1 - sa * cy1 + (pt0.x + pt1.x) / 2;
+        T const cy = sa * cx1 + ca * cy1 + (pt0.y + pt1.y) / 2;
+
+        transforms::affine<T> affine;
+        affine.scale(rx, ry).rotate(sa, ca).translate(cx, cy);
+        auto u = vectors::unit(vector<T>((x1 - cx1) / rx, (y1 - cy1) / ry));
+        auto v = vectors::unit(vector<T>((-x1 - cx1) / rx, (-y1 - cy1) / ry));
+        point<T> pts[13];
+        auto end = bezier::build_cubic_arc(u, v, sweep, &affine, pts);
+        if (end - pts == 1)
+        {
+            sink(command::line_to, pt1);
+            return;
+        }
+        end[-1] = pt1;
+        for (auto it = pts + 1; it != end; it += 3)
+            sink(command::cubic_to, it[0], it[1], it[2]);
+    }
+}}
+
+namespace niji
+{
+    // Parses the SVG path data (the "d" attribute) and sends the commands to
+    // the sink, the arcs are converted to cubics.
+    //
+    // Returns where the parsing stops, which is `last` on success. As SVG
+    // specifies, the commands before the error are still rendered.
+    template<class T, class Sink>
+    char const* parse_svg_path(char const* first, char const* last, Sink& sink)
+    {
+        using namespace command;
+
+        detail::svg_scanner s{first, last};
+        point<T> cur(0, 0), start(0, 0), ctrl, pt1, pt2, pt3;
+        bool open = false, moved = false;
+        char prev = 0;
+
+        // After 'Z', the next figure starts from the start of the last one.
+        auto begin_segment = [&]
+        {
+            if (!moved)
+            {
+                sink(move_to, cur);
+                moved = open = true;
+            }
+        };
+        auto reflect = [&](point<T> const& pt)
+        {
+            return point<T>(2 * cur.x - pt.x, 2 * cur.y - pt.y);
+        };
+        auto offset = [&](point<T>& pt, bool rel)
+        {
+            if (rel)
+                pt.x += cur.x, pt.y += cur.y;
+        };
+
+        s.skip_space();
+        while (s.it != last)
+        {
+            char const cmd = *s.it;
+            bool const rel = cmd >= 'a';
+            char op = rel ? cmd - ('a' - 'A') : cmd;
+            // The path must start with a moveto.
+            if (!prev && op != 'M')
+                break;
+            char const* const pos = s.it++;
+            s.skip_space();
+            if (op == 'Z')
+            {
+                if (open)
+                    sink(end_closed);
+                open = moved = false;
+                cur = start;
+                prev = op;
+                continue;
+            }
+            bool ok = true;
+            char const* args;
+            do
+            {
+                args = s.it;
+                switch (op)
+                {
+                case 'M':
+                    if (!(ok = s.point(pt1)))
+                        break;
+                    offset(pt1, rel && prev);
+                    if (open)
+                        sink(end_open);
+                    sink(move_to, pt1);
+                    open = moved = true;
+                    start = cur = pt1;
+                    // The subsequent pairs are implicit lines.
+                    op = 'L';
+                    break;
+                case 'L':
+                    if (!(ok = s.point(pt1)))
+                        break;
+                    offset(pt1, rel);
+                    begin_segment();
+                    sink(line_to, pt1);
+                    cur = pt1;
+                    break;
+                case 'H':
+                    if (!(ok = s.number(pt1.x)))
+                        break;
+                    if (rel)
+                        pt1.x += cur.x;
+                    pt1.y = cur.y;
+                    begin_segment();
+                    sink(line_to, pt1);
+                    cur = pt1;
+                    break;
+                case 'V':
+                    if (!(ok = s.number(pt1.y)))
+                        break;
+                    if (rel)
+                        pt1.y += cur.y;
+                    pt1.x = cur.x;
+                    begin_segment();
+                    sink(line_to, pt1);
+                    cur = pt1;
+                    break;
+                case 'Q':
+                    if (!(ok = s.point(pt1) && s.point(pt2)))
+                        break;
+                    offset(pt1, rel), offset(pt2, rel);
+                    begin_segment();
+                    sink(quad_to, pt1, pt2);
+                    ctrl = pt1, cur = pt2;
+                    break;
+                case 'T':
+                    if (!(ok = s.point(pt2)))
+                        break;
+                    offset(pt2, rel);
+                    pt1 = prev == 'Q' || prev == 'T' ? reflect(ctrl) : cur;
+                    begin_segment();
+                    sink(quad_to, pt1, pt2);
+                    ctrl = pt1, cur = pt2;
+                    break;
+                case 'C':
+                    if (!(ok = s.point(pt1) && s.point(pt2) && s.point(pt3)))
+                        break;
+                    offset(pt1, rel), offset(pt2, rel), offset(pt3, rel);
+                    begin_segment();
+                    sink(cubic_to, pt1, pt2, pt3);
+                    ctrl = pt2, cur = pt3;
+                    break;
+                case 'S':
+                    if (!(ok = s.point(pt2) && s.point(pt3)))
+                        break;
+                    offset(pt2, rel), offset(pt3, rel);
+                    pt1 = prev == 'C' || prev == 'S' ? reflect(ctrl) : cur;
+                    begin_segment();
+                    sink(cubic_to, pt1, pt2, pt3);
+                    ctrl = pt2, cur = pt3;
+                    break;
+                case 'A':
+                {
+                    T rx, ry, angle;
+                    bool large_arc, sweep;
+                    if (!(ok = s.number(rx) && s.number(ry) && s.number(angle) &&
+                        s.flag(large_arc) && s.flag(sweep) && s.point(pt1)))
+                        break;
+                    offset(pt1, rel);
+                    begin_segment();
+                    detail::svg_arc(sink, cur, rx, ry, angle, large_arc, sweep, pt1);
+                    cur = pt1;
+                    break;
+                }
+                default:
+                    args = pos;
+                    ok = false;
+                }
+                prev = op;
+            } while (ok && s.at_number());
+            if (!ok)
+            {
+                s.it = args;
+                break;
+            }
+        }
+        if (open)
+            sink(end_open);
+        return s.it;
+    }
+
+    // The SVG path data as a path, parsed on each render.
+    template<class T>
+    struct svg_path
+    {
+        using point_type = point<T>;
+
+        std::string_view data;
+
+        explicit svg_path(std::string_view data) : data(data) {}
+
+        template<class Sink>
+        void render(Sink& sink) const
+        {
+            parse_svg_path<T>(data.data(), data.data() + data.size(), sink);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,148 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+#ifndef NIJI_LOD_PATH_HPP_INCLUDED
+#define NIJI_LOD_PATH_HPP_INCLUDED
+
+#include <vector>
+#include <cstddef>
+#include <iterator>
+#include <algorithm>
+#include <initializer_list>
+#include <niji/path.hpp>
+#include <niji/render.hpp>
+#include <niji/support/point.hpp>
+#include <niji/support/tolerance.hpp>
+#include <niji/view/simplify.hpp>
+#include <niji/view/transform.hpp>
+
+namespace niji
+{
+    // Levels of detail of the path, simplified by views::simplify with the
+    // tolerances once on construction. The level is picked per render by
+    // the scale (device units per user unit), the coarsest one that's still
+    // within the device tolerance, so the zoomed out views send far fewer
+    // vertices.
+    //
+    // Level 0 is the path itself, with tolerance 0.
+    template<class T>
+    class lod_path
+    {
+        using path_t = path<point<T>>;
+
+        struct level_t
+        {
+            T tolerance;
+            path_t path;
+        };
+
+    public:
+
+        using point_type = point<T>;
+
+        lod_path() = default;
+
+        template<class Path, class Tolerances>
+        lod_path(Path const& path, Tolerances const& tolerances, T device_tolerance = T(NIJI_DEVICE_TOLERANCE))
+          : _device_tolerance(device_tolerance)
+        {
+            build(path, std::begin(tolerances), std::end(tolerances));
+        }
+
+        template<class Path>
+        lod_path(Path const& path, std::initializer_list<T> tolerances, T device_tolerance = T(NIJI_DEVICE_TOLERANCE))
+          : _device_tolerance(device_tolerance)
+        {
+            build(path, tolerances.begin(), tolerances.end());
+        }
+
+        // Renders the level picked by the current scale.
+        template<class Sink>
+        void render(Sink& sink) const
+        {
+            select(_scale).render(sink);
+        }
+
+        template<class Sink>
+        void inverse_render(Sink& sink) const
+        {
+            select(_scale).inverse_render(sink);
+        }
+
+        path_t const& select(T scale) const
+        {
+            std::size_t i = _levels.size();
+            while (--i && _levels[i].tolerance * scale > _device_tolerance);
+            return _levels[i].path;
+        }
+
+        T scale() const
+        {
+            return _scale;
+        }
+
+        void scale(T scale)
+        {
+            _scale = scale;
+        }
+
+        T device_tolerance() const
+        {
+            return _device_tolerance;
+        }
+
+        void device_tolerance(T tolerance)
+        {
+            _device_tolerance = tolerance;
+        }
+
+        std::size_t size() const
+        {
+            return _levels.size();
+        }
+
+        path_t const& level(std::size_t i) const
+        {
+            return _levels[i].path;
+        }
+
+        T tolerance(std::size_t i) const
+        {
+            return _levels[i].tolerance;
+        }
+
+    private:
+
+        template<class Path, class Iter>
+        void build(Path const& path, Iter first, Iter last)
+        {
+            std::vector<T> tolerances;
+            for (; first != last; ++first)
+            {
+                if (*first > 0)
+                    tolerances.push_back(*first);
+            }
+            std::sort(tolerances.begin(), tolerances.end());
+            tolerances.erase(std::unique(tolerances.begin(), tolerances.end()), tolerances.end());
+            _levels.clear();
+            _levels.reserve(tolerances.size() + 1);
+            _levels.push_back(level_t{T(0), path_t(path | views::transform([](auto const& pt)
+            {
+                return point<T>(convert_geometry<point<T>>(pt));
+            }))});
+            // All simplified from the path itself, so the error doesn't
+            // accumulate across the levels.
+            for (T tolerance : tolerances)
+                _levels.push_back(level_t{tolerance, path_t(_levels.front().path | views::simplify<T>(tolerance))});
+        }
+
+        std::vector<level_t> _levels = std::vector<level_t>(1);
+        T _scale = 1;
+        T _device_tolerance = T(NIJI_DEVICE_TOLERANCE);
+    };
+}
+
+#endif
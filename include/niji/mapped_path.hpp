@@ -0,0 +1,386 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+#ifndef NIJI_MAPPED_PATH_HPP_INCLUDED
+#define NIJI_MAPPED_PATH_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+#include <type_traits>
+#include <boost/endian/arithmetic.hpp>
+#include <boost/geometry/core/access.hpp>
+#include <niji/render.hpp>
+#include <niji/group.hpp>
+#include <niji/support/box.hpp>
+#include <niji/support/point.hpp>
+#include <niji/support/command.hpp>
+#include <niji/sink/recording.hpp>
+#include <niji/algorithm/bounds.hpp>
+#include <niji/detail/verb.hpp>
+#include <niji/detail/flat_path.hpp>
+
+// B I N A R Y   L A Y O U T
+// -------------------------
+// All the numbers are little-endian, each record starts at an 8-byte
+// boundary relative to the buffer.
+//
+// path record:
+//   char[4]    magic "NJIP"
+//   uint16     version
+//   uint16     flags (see binary::flags)
+//   uint32     verb count
+//   uint32     point count
+//   coord[4]   bounds (min x, min y, max x, max y), if flags::bounds
+//   char[]     verbs, as detail::verb, padded to 8 bytes
+//   coord[]    xs, then ys
+//
+// group record:
+//   char[4]    magic "NJIG"
+//   uint16     version
+//   uint16     flags, only flags::float64 is used
+//   uint32     path count
+//   uint32     reserved
+//   uint64[]   offsets of the path records relative to the group record,
+//              path count + 1 where the last is the end of the group
+//   path records
+
+namespace niji { namespace binary
+{
+    constexpr std::uint16_t version = 1;
+
+    enum flags : std::uint16_t
+    {
+        float64 = 1,
+        bounds = 2
+    };
+
+    template<class T>
+    using coord_t = std::conditional_t<sizeof(T) == 4,
+        boost::endian::little_float32_t, boost::endian::little_float64_t>;
+
+    struct path_header
+    {
+        char magic[4];
+        boost::endian::little_uint16_t version;
+        boost::endian::little_uint16_t flags;
+        boost::endian::little_uint32_t verb_count;
+        boost::endian::little_uint32_t point_count;
+    };
+
+    struct group_header
+    {
+        char magic[4];
+        boost::endian::little_uint16_t version;
+        boost::endian::little_uint16_t flags;
+        boost::endian::little_uint32_t path_count;
+        boost::endian::little_uint32_t reserved;
+    };
+
+    static_assert(sizeof(path_header) == 16 && sizeof(group_header) == 16, "packed headers");
+
+    inline std::size_t align(std::size_t n)
+    {
+        return (n + 7) & ~std::size_t(7);
+    }
+
+    template<class T>
+    inline std::uint16_t coord_flag()
+    {
+        static_assert(std::is_floating_point<T>::value && (sizeof(T) == 4 || sizeof(T) == 8),
+            "only float & double are supported");
+        return sizeof(T) == 8 ? flags::float64 : 0;
+    }
+}}
+
+namespace niji { namespace detail
+{
+    template<class Header>
+    inline Header* binary_append(std::vector<char>& out, std::size_t n)
+    {
+        out.resize(binary::align(out.size()));
+        std::size_t pos = out.size();
+        out.resize(pos + n);
+        return reinterpret_cast<Header*>(out.data() + pos);
+    }
+
+    template<class T>
+    inline void binary_write_coords(char* p, std::size_t n, T const* coords)
+    {
+        auto dst = reinterpret_cast<binary::coord_t<T>*>(p);
+        for (std::size_t i = 0; i != n; ++i)
+            dst[i] = coords[i];
+    }
+}}
+
+namespace niji
+{
+    // Appends the path record to `out`, the coordinates are stored as T.
+    template<class T, class Path>
+    void write_binary(Path const& path, std::vector<char>& out, bool with_bounds = true)
+    {
+        using coord_t = binary::coord_t<T>;
+
+        using boost::geometry::get;
+
+        recording_sink<path_point_t<Path>> rec;
+        niji::render(path, rec);
+        auto verbs = rec.verbs();
+        auto pts = rec.points();
+        std::size_t const nv = verbs.size(), np = pts.size();
+        std::size_t size = sizeof(binary::path_header) + (with_bounds ? 4 * sizeof(coord_t) : 0);
+        std::size_t const verb_pos = size;
+        size += binary::align(nv);
+        std::size_t const coord_pos = size;
+        size += 2 * np * sizeof(coord_t);
+
+        auto header = detail::binary_append<binary::path_header>(out, size);
+        auto base = reinterpret_cast<char*>(header);
+        std::memcpy(header->magic, "NJIP", 4);
+        header->version = binary::version;
+        header->flags = binary::coord_flag<T>() | (with_bounds ? binary::flags::bounds : 0);
+        header->verb_count = static_cast<std::uint32_t>(nv);
+        header->point_count = static_cast<std::uint32_t>(np);
+        if (with_bounds)
+        {
+            auto box = niji::bounds(rec);
+            T b[4] = {T(get<0>(box.min_corner)), T(get<1>(box.min_corner)), T(get<0>(box.max_corner)), T(get<1>(box.max_corner))};
+            detail::binary_write_coords(base + sizeof(binary::path_header), 4, b);
+        }
+        if (nv)
+            std::memcpy(base + verb_pos, verbs.begin(), nv);
+        std::vector<T> xs(np), ys(np);
+        for (std::size_t i = 0; i != np; ++i)
+        {
+            xs[i] = T(get<0>(pts[i]));
+            ys[i] = T(get<1>(pts[i]));
+        }
+        detail::binary_write_coords(base + coord_pos, np, xs.data());
+        detail::binary_write_coords(base + coord_pos + np * sizeof(coord_t), np, ys.data());
+    }
+
+    // Appends the group record to `out`.
+    template<class T, class Path, class Alloc>
+    void write_binary(group<Path, Alloc> const& g, std::vector<char>& out, bool with_bounds = true)
+    {
+        std::size_t const n = g.size();
+        std::size_t const table = sizeof(binary::group_header) + (n + 1) * 8;
+        detail::binary_append<char>(out, table);
+        std::size_t const pos = out.size() - table;
+        std::vector<std::uint64_t> offsets;
+        offsets.reserve(n + 1);
+        for (auto const& path : g)
+        {
+            out.resize(binary::align(out.size()));
+            offsets.push_back(out.size() - pos);
+            write_binary<T>(path, out, with_bounds);
+        }
+        offsets.push_back(out.size() - pos);
+
+        auto header = reinterpret_cast<binary::group_header*>(out.data() + pos);
+        std::memcpy(header->magic, "NJIG", 4);
+        header->version = binary::version;
+        header->flags = binary::coord_flag<T>();
+        header->path_count = static_cast<std::uint32_t>(n);
+        header->reserved = 0;
+        auto dst = reinterpret_cast<boost::endian::little_uint64_t*>(header + 1);
+        for (std::size_t i = 0; i <= n; ++i)
+            dst[i] = offsets[i];
+    }
+
+    // A read-only path rendered straight from a path record, e.g. in a
+    // memory-mapped file, nothing is copied. The buffer must outlive it.
+    template<class T>
+    class mapped_path
+    {
+        using coord_t = binary::coord_t<T>;
+        using iterator_t = detail::soa_iterator<point<T>, coord_t const*>;
+
+    public:
+
+        using point_type = point<T>;
+
+        mapped_path()
+          : _verbs(), _xs(), _ys(), _bounds(), _verb_count(), _point_count()
+        {}
+
+        // The path is left empty if the record is invalid, see assign.
+        mapped_path(char const* data, std::size_t size) : mapped_path()
+        {
+            assign(data, size);
+        }
+
+        // Returns false if the record is invalid or of another coordinate
+        // type, in which case the path is left empty.
+        bool assign(char const* data, std::size_t size)
+        {
+            *this = mapped_path();
+            if (size < sizeof(binary::path_header))
+                return false;
+            auto header = reinterpret_cast<binary::path_header const*>(data);
+            if (std::memcmp(header->magic, "NJIP", 4) || header->version != binary::version ||
+                (header->flags & binary::flags::float64) != binary::coord_flag<T>())
+                return false;
+            std::size_t const nv = header->verb_count, np = header->point_count;
+            bool const has_bounds = header->flags & binary::flags::bounds;
+            std::size_t verb_pos = sizeof(binary::path_header) + (has_bounds ? 4 * sizeof(coord_t) : 0);
+            std::size_t coord_pos = verb_pos + binary::align(nv);
+            if (coord_pos + 2 * np * sizeof(coord_t) > size ||
+                !detail::verb::check(data + verb_pos, data + verb_pos + nv, np))
+                return false;
+            _bounds = has_bounds ? reinterpret_cast<coord_t const*>(data + sizeof(binary::path_header)) : nullptr;
+            _verbs = data + verb_pos;
+            _xs = reinterpret_cast<coord_t const*>(data + coord_pos);
+            _ys = _xs + np;
+            _verb_count = nv;
+            _point_count = np;
+            return true;
+        }
+
+        template<class Sink>
+        void render(Sink& sink) const
+        {
+            if (detail::verb_render_impl(sink, _verbs, _verbs + _verb_count, iterator_t(_xs, _ys)))
+                sink(command::end_open);
+        }
+
+        template<class Sink>
+        void inverse_render(Sink& sink) const
+        {
+            detail::verb_inverse_render_impl(sink, _verbs, _verbs + _verb_count, iterator_t(_xs + _point_count, _ys + _point_count));
+        }
+
+        // The stored bounds if any, otherwise computed.
+        box<point<T>> bounds() const
+        {
+            if (_bounds)
+                return {point<T>(_bounds[0], _bounds[1]), point<T>(_bounds[2], _bounds[3])};
+            detail::bounds_sink<T> sink;
+            render(sink);
+            return {sink.min, sink.max};
+        }
+
+        bool has_bounds() const
+        {
+            return _bounds;
+        }
+
+        std::size_t size() const
+        {
+            return _point_count;
+        }
+
+        bool empty() const
+        {
+            return !_verb_count;
+        }
+
+    private:
+
+        char const* _verbs;
+        coord_t const* _xs;
+        coord_t const* _ys;
+        coord_t const* _bounds;
+        std::size_t _verb_count, _point_count;
+    };
+
+    // A read-only group of mapped_path from a group record.
+    template<class T>
+    class mapped_group
+    {
+        using offset_t = boost::endian::little_uint64_t;
+
+    public:
+
+        using point_type = point<T>;
+        using path_type = mapped_path<T>;
+
+        mapped_group() : _data(), _offsets(), _size() {}
+
+        mapped_group(char const* data, std::size_t size) : mapped_group()
+        {
+            assign(data, size);
+        }
+
+        // Returns false if the record is invalid or of another coordinate
+        // type, in which case the group is left empty. The path records are
+        // validated when accessed.
+        bool assign(char const* data, std::size_t size)
+        {
+            *this = mapped_group();
+            if (size < sizeof(binary::group_header))
+                return false;
+            auto header = reinterpret_cast<binary::group_header const*>(data);
+            if (std::memcmp(header->magic, "NJIG", 4) || header->version != binary::version ||
+                (header->flags & binary::flags::float64) != binary::coord_flag<T>())
+                return false;
+            std::size_t const n = header->path_count;
+            if (sizeof(binary::group_header) + (n + 1) * sizeof(offset_t) > size)
+                return false;
+            // The offsets are aligned & ascending within the record.
+            auto offsets = reinterpret_cast<offset_t const*>(header + 1);
+            for (std::size_t i = 0; i <= n; ++i)
+            {
+                std::uint64_t const offset = offsets[i];
+                if (offset > size || offset & 7 || (i && offset < offsets[i - 1]))
+                    return false;
+            }
+            _data = data;
+            _offsets = offsets;
+            _size = n;
+            return true;
+        }
+
+        // Paths
+        //----------------------------------------------------------------------
+        mapped_path<T> operator[](std::size_t i) const
+        {
+            std::size_t const begin = _offsets[i], end = _offsets[i + 1];
+            return mapped_path<T>(_data + begin, end - begin);
+        }
+
+        std::size_t size() const
+        {
+            return _size;
+        }
+
+        bool empty() const
+        {
+            return !_size;
+        }
+
+        // The size of the group record.
+        std::size_t size_bytes() const
+        {
+            return _size ? static_cast<std::size_t>(_offsets[_size]) : 0;
+        }
+
+        // Traverse
+        //----------------------------------------------------------------------
+        template<class Sink>
+        void render(Sink& sink) const
+        {
+            for (std::size_t i = 0; i != _size; ++i)
+                niji::render((*this)[i], sink);
+        }
+
+        template<class Sink>
+        void inverse_render(Sink& sink) const
+        {
+            for (std::size_t i = 0; i != _size; ++i)
+                niji::inverse_render((*this)[i], sink);
+        }
+
+    private:
+
+        char const* _data;
+        offset_t const* _offsets;
+        std::size_t _size;
+    };
+}
+
+#endif
@@ -0,0 +1,453 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+#ifndef NIJI_MEASURED_PATH_HPP_INCLUDED
+#define NIJI_MEASURED_PATH_HPP_INCLUDED
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <initializer_list>
+#include <niji/path.hpp>
+#include <niji/render.hpp>
+#include <niji/support/command.hpp>
+#include <niji/support/point.hpp>
+#include <niji/support/vector.hpp>
+#include <niji/support/bezier.hpp>
+#include <niji/support/numeric.hpp>
+
+// Number of table entries per curve.
+#ifndef NIJI_MEASURE_CURVE_SAMPLES
+#   define NIJI_MEASURE_CURVE_SAMPLES 16
+#endif
+
+namespace niji { namespace detail
+{
+    template<class T>
+    struct measured_segment
+    {
+        point<T> pts[4];
+        T start; // distance at the start
+        char kind; // number of points
+        bool head; // first segment of a figure
+
+        point<T> eval(T t) const
+        {
+            switch (kind)
+            {
+            case 2:
+                return points::interpolate(pts[0], pts[1], t);
+            case 3:
+                return {bezier::quad_eval(pts[0].x, pts[1].x, pts[2].x, t),
+                        bezier::quad_eval(pts[0].y, pts[1].y, pts[2].y, t)};
+            default:
+                return {bezier::cubic_eval(pts[0].x, pts[1].x, pts[2].x, pts[3].x, t),
+                        bezier::cubic_eval(pts[0].y, pts[1].y, pts[2].y, pts[3].y, t)};
+            }
+        }
+
+        vector<T> velocity(T t) const
+        {
+            T s = 1 - t;
+            switch (kind)
+            {
+            case 2:
+                return pts[1] - pts[0];
+            case 3:
+                return ((pts[1] - pts[0]) * s + (pts[2] - pts[1]) * t) * T(2);
+            default:
+                return ((pts[1] - pts[0]) * (s * s) + (pts[2] - pts[1]) * (2 * s * t) + (pts[3] - pts[2]) * (t * t)) * T(3);
+            }
+        }
+
+        // The direction at t, which falls back to the chords if the
+        // velocity vanishes, i.e. degenerated control points.
+        vector<T> direction(T t) const
+        {
+            vector<T> v(velocity(t));
+            if (kind == 2 || vectors::norm_square(v))
+                return v;
+            v = t < T(0.5) ? pts[2] - pts[0] : pts[kind - 1] - pts[kind - 3];
+            return vectors::norm_square(v) ? v : pts[kind - 1] - pts[0];
+        }
+
+        // Length of the part in [t0, t1] by Gauss-Legendre quadrature, same
+        // as bezier::quad_length & cubic_length on the chopped curve.
+        T length(T t0, T t1) const
+        {
+            switch (kind)
+            {
+            case 2:
+                return vectors::norm(pts[1] - pts[0]) * (t1 - t0);
+            case 3:
+                return quadrature<3>(t0, t1);
+            default:
+                return quadrature<4>(t0, t1);
+            }
+        }
+
+        template<int N>
+        T quadrature(T t0, T t1) const
+        {
+            T sum = 0, h = t1 - t0;
+            for (int i = 0; i != N; ++i)
+                sum += detail::lg_c<T, N>[i] * vectors::norm(velocity(t0 + h * detail::lg_t<T, N>[i]));
+            return sum * h / 2;
+        }
+
+        // Renders the part in [t0, t1] without the leading point.
+        template<class Sink>
+        void render(Sink& sink, T t0, T t1) const
+        {
+            using namespace command;
+
+            if (kind == 2)
+            {
+                sink(line_to, eval(t1));
+                return;
+            }
+            // Chopped only if needed.
+            point<T> head[7], tail[7];
+            point<T> const* src = pts;
+            if (t0 > 0)
+            {
+                kind == 3 ? bezier::chop_quad_at(src, head, t0) : bezier::chop_cubic_at(src, head, t0);
+                src = head + (kind - 1);
+                t1 = (t1 - t0) / (1 - t0);
+            }
+            if (t1 < 1)
+            {
+                kind == 3 ? bezier::chop_quad_at(src, tail, t1) : bezier::chop_cubic_at(src, tail, t1);
+                src = tail;
+            }
+            if (kind == 3)
+                sink(quad_to, src[1], src[2]);
+            else
+                sink(cubic_to, src[1], src[2], src[3]);
+        }
+    };
+
+    // Distance at the end of the span of t, for binary search.
+    template<class T>
+    struct measure_entry
+    {
+        T distance;
+        T t;
+        std::size_t segment;
+
+        friend bool operator<(measure_entry const& a, T d)
+        {
+            return a.distance < d;
+        }
+
+        friend bool operator<(T d, measure_entry const& a)
+        {
+            return d < a.distance;
+        }
+    };
+
+    template<class T>
+    struct measure_sink
+    {
+        std::vector<measured_segment<T>>& segments;
+        std::vector<measure_entry<T>>& table;
+        point<T> _first, _pt0;
+        T _length;
+        bool _head;
+
+        void operator()(move_to_t, point<T> const& pt)
+        {
+            _first = _pt0 = pt;
+            _head = true;
+        }
+
+        void operator()(line_to_t, point<T> const& pt1)
+        {
+            push({_pt0, pt1}, 2, 1);
+            _pt0 = pt1;
+        }
+
+        void operator()(quad_to_t, point<T> const& pt1, point<T> const& pt2)
+        {
+            push({_pt0, pt1, pt2}, 3, NIJI_MEASURE_CURVE_SAMPLES);
+            _pt0 = pt2;
+        }
+
+        void operator()(cubic_to_t, point<T> const& pt1, point<T> const& pt2, point<T> const& pt3)
+        {
+            push({_pt0, pt1, pt2, pt3}, 4, NIJI_MEASURE_CURVE_SAMPLES);
+            _pt0 = pt3;
+        }
+
+        void operator()(end_open_t) {}
+
+        void operator()(end_closed_t)
+        {
+            operator()(line_to_t{}, _first);
+        }
+
+        void push(std::initializer_list<point<T>> pts, char kind, int samples)
+        {
+            measured_segment<T> seg;
+            std::copy(pts.begin(), pts.end(), seg.pts);
+            seg.start = _length;
+            seg.kind = kind;
+            seg.head = _head;
+            _head = false;
+            auto const index = segments.size();
+            segments.push_back(seg);
+            // Each span is measured on its own, which is more accurate than
+            // measuring from the start.
+            for (int i = 0; i != samples; ++i)
+            {
+                T t0 = T(i) / samples, t1 = T(i + 1) / samples;
+                _length += segments.back().length(t0, t1);
+                table.push_back({_length, t1, index});
+            }
+        }
+    };
+}}
+
+namespace niji
+{
+    // A path with its cumulative arc-length table, which is built once so
+    // that the queries by distance are O(log n).
+    // The distance runs through all the figures, the closed ones include
+    // their closing lines.
+    template<class T>
+    class measured_path
+    {
+        using segment_t = detail::measured_segment<T>;
+        using entry_t = detail::measure_entry<T>;
+
+    public:
+
+        using point_type = point<T>;
+
+        measured_path() = default;
+
+        template<class Path>
+        explicit measured_path(Path const& path)
+          : _path(path)
+        {
+            detail::measure_sink<T> sink{_segments, _table};
+            sink._length = 0;
+            sink._head = true;
+            niji::render(_path, sink);
+        }
+
+        template<class Sink>
+        void render(Sink& sink) const
+        {
+            _path.render(sink);
+        }
+
+        template<class Sink>
+        void inverse_render(Sink& sink) const
+        {
+            _path.inverse_render(sink);
+        }
+
+        T length() const
+        {
+            return _table.empty() ? T(0) : _table.back().distance;
+        }
+
+        // A default point & tangent for an empty path.
+        point<T> point_at(T distance) const
+        {
+            if (_table.empty())
+                return point<T>();
+            T t;
+            auto const& seg = locate(distance, t);
+            return seg.eval(t);
+        }
+
+        vector<T> tangent_at(T distance) const
+        {
+            if (_table.empty())
+                return vector<T>();
+            T t;
+            auto const& seg = locate(distance, t);
+            return vectors::unit(seg.direction(t));
+        }
+
+        // Renders the part in [d0, d1] as open figures.
+        template<class Sink>
+        void segment(T d0, T d1, Sink& sink) const
+        {
+            auto cursor = _table.begin();
+            segment(d0, d1, sink, cursor);
+        }
+
+        // Renders the dashes along the path, in the same manner as
+        // detail::dasher, i.e. the pattern runs through all the figures.
+        template<class Iterator, class U, class Sink>
+        void dash(Iterator const& begin, Iterator const& end, T offset, U weight, Sink& sink) const
+        {
+            using std::fmod;
+
+            T period = 0;
+            for (auto it = begin; it != end; ++it)
+                period += weight * (*it);
+            if (!(period > 0))
+                return;
+            T const len = length();
+            T d = offset > 0 ? -fmod(offset, period) : T(0);
+            // The pattern always restarts with a dash, so a dash at the end
+            // of an odd pattern is merged with the next one.
+            T a = 0, b = -1;
+            auto cursor = _table.begin();
+            while (d < len)
+            {
+                bool on = true;
+                for (auto it = begin; it != end && d < len; ++it, on = !on)
+                {
+                    T next = d + weight * (*it);
+                    if (on)
+                    {
+                        if (d != b)
+                        {
+                            segment(a, b, sink, cursor);
+                            a = d;
+                        }
+                        b = next;
+                    }
+                    d = next;
+                }
+            }
+            segment(a, b, sink, cursor);
+        }
+
+        // Calls f(pt, u) at every step, the same as niji::generate_tangents.
+        template<class F>
+        void generate_tangents(T step, T offset, F&& f) const
+        {
+            using std::fmod;
+
+            offset = fmod(offset, step);
+            if (offset < 0)
+                offset += step;
+            auto cursor = _table.begin();
+            T const len = length();
+            for (T d = step - offset; d <= len; d += step)
+            {
+                T t;
+                auto const& seg = _segments[index(d, t, false, cursor)];
+                f(seg.eval(t), vectors::unit(seg.direction(t)));
+            }
+        }
+
+        bool empty() const
+        {
+            return _segments.empty();
+        }
+
+    private:
+
+        using cursor_t = typename std::vector<entry_t>::const_iterator;
+
+        // The cursor is where the search starts, which is updated to the
+        // found entry, i.e. the increasing queries take amortized O(1).
+        template<class Sink>
+        void segment(T d0, T d1, Sink& sink, cursor_t& cursor) const
+        {
+            using namespace command;
+
+            d0 = std::max(d0, T(0));
+            d1 = std::min(d1, length());
+            if (_table.empty() || !(d0 < d1))
+                return;
+            T t0, t1;
+            auto i = index(d0, t0, true, cursor), j = index(d1, t1, false, cursor);
+            sink(move_to, _segments[i].eval(t0));
+            for ( ; i != j; ++i, t0 = 0)
+            {
+                _segments[i].render(sink, t0, 1);
+                if (_segments[i + 1].head)
+                {
+                    sink(end_open);
+                    sink(move_to, _segments[i + 1].pts[0]);
+                }
+            }
+            _segments[j].render(sink, t0, t1);
+            sink(end_open);
+        }
+
+        // Exponential search from the cursor.
+        // If after, a distance at the boundary goes to the later segment.
+        cursor_t find(T distance, bool after, cursor_t& cursor) const
+        {
+            auto before = [=](entry_t const& e)
+            {
+                return after ? !(distance < e.distance) : e.distance < distance;
+            };
+            auto lo = cursor, end = _table.end();
+            std::ptrdiff_t step = 1;
+            while (step < end - lo && before(lo[step]))
+            {
+                lo += step;
+                step *= 2;
+            }
+            auto hi = step < end - lo ? lo + step : end;
+            auto it = after ?
+                std::upper_bound(lo, hi, distance) :
+                std::lower_bound(lo, hi, distance);
+            if (it == end)
+                --it;
+            return cursor = it;
+        }
+
+        std::size_t index(T distance, T& t, bool after, cursor_t& cursor) const
+        {
+            auto it = find(distance, after, cursor);
+            T d0 = _segments[it->segment].start, t0 = 0;
+            if (it != _table.begin() && it[-1].segment == it->segment)
+                d0 = it[-1].distance, t0 = it[-1].t;
+            T span = it->distance - d0;
+            if (!(span > 0))
+            {
+                t = it->t;
+                return it->segment;
+            }
+            T l = std::min(std::max(distance - d0, T(0)), span);
+            t = t0 + (it->t - t0) * l / span;
+            auto const& seg = _segments[it->segment];
+            if (seg.kind != 2)
+            {
+                // Newton's method on the length within the span.
+                for (int i = 0; i != 2; ++i)
+                {
+                    T err = seg.length(t0, t) - l;
+                    T speed = vectors::norm(seg.velocity(t));
+                    if (numeric::is_nearly_zero(std::abs(err)) || !(speed > 0))
+                        break;
+                    t = std::min(std::max(t - err / speed, t0), it->t);
+                }
+            }
+            return it->segment;
+        }
+
+        segment_t const& locate(T distance, T& t) const
+        {
+            auto cursor = _table.begin();
+            return _segments[index(distance, t, false, cursor)];
+        }
+
+        path<point<T>> _path;
+        std::vector<segment_t> _segments;
+        std::vector<entry_t> _table;
+    };
+
+    // Same as the generic one, without measuring the curves again.
+    template<class T, class U, class F>
+    void generate_tangents(measured_path<T> const& path, U const& step, U const& offset, F&& f)
+    {
+        path.generate_tangents(step, offset, f);
+    }
+}
+
+#endif
@@ -7,14 +7,20 @@
 #ifndef NIJI_PATH_HPP_INCLUDED
 #define NIJI_PATH_HPP_INCLUDED
 
+#include <memory>
+#include <algorithm>
 #include <initializer_list>
 #include <boost/assert.hpp>
 #include <boost/container/vector.hpp>
 #include <boost/container/deque.hpp>
 #include <boost/container/allocator_traits.hpp>
+#include <boost/archive/archive_exception.hpp>
+#include <boost/serialization/version.hpp>
 #include <niji/path_fwd.hpp>
 #include <niji/render.hpp>
 #include <niji/detail/path.hpp>
+#include <niji/detail/verb.hpp>
+#include <niji/support/batch.hpp>
 
 namespace niji
 {
@@ -25,13 +31,11 @@ namespace niji
         friend class path;
 
         using nodes_base = boost::container::deque<Node, Alloc>;
-        using index_tag_t = detail::index_tag_t;
-        using index_tag_alloc_t =
+        using verb_alloc_t =
             typename boost::container::allocator_traits<Alloc>::template
-                portable_rebind_alloc<index_tag_t>::type;
-        using index_tag_container =
-            boost::container::vector<index_tag_t, index_tag_alloc_t>;
-        using index_tag_iterator = typename index_tag_container::const_iterator;
+                portable_rebind_alloc<char>::type;
+        using verb_container = boost::container::vector<char, verb_alloc_t>;
+        using verb_iterator = typename verb_container::const_iterator;
 
     public:
         
@@ -51,23 +55,23 @@ namespace niji
         using nodes_base::size;
         using nodes_base::empty;
 
-        using figures_view = detail::path_partition<iterator, index_tag_iterator>;
-        using const_figures_view = detail::path_partition<const_iterator, index_tag_iterator>;
-        using incomplete_view = detail::incomplete_path<const_iterator, index_tag_iterator>;
+        using figures_view = detail::path_partition<iterator, verb_iterator>;
+        using const_figures_view = detail::path_partition<const_iterator, verb_iterator>;
+        using incomplete_view = detail::incomplete_path<const_iterator, verb_iterator>;
 
         figures_view figures()
         {
-            return {nodes_base::begin(), nodes_base::end(), _index_tags.begin(), _index_tags.end()};
+            return {nodes_base::begin(), _verbs.begin(), _verbs.end()};
         }
 
         const_figures_view figures() const
         {
-            return {nodes_base::begin(), nodes_base::end(), _index_tags.begin(), _index_tags.end()};
+            return {nodes_base::begin(), _verbs.begin(), _verbs.end()};
         }
 
         incomplete_view incomplete() const
         {
-            return {nodes_base::begin(), nodes_base::end(), _index_tags.begin(), _index_tags.end()};
+            return {nodes_base::begin(), nodes_base::end(), _verbs.begin(), _verbs.end()};
         }
 
         bool is_box() const
@@ -77,9 +81,7 @@ namespace niji
 
         bool is_ended() const
         {
-            return nodes_base::empty() || 
-                (!_index_tags.empty() &&
-                    _index_tags.back().index == nodes_base::size());
+            return detail::verb::is_ended(_verbs);
         }
 
         struct sink
@@ -147,34 +149,38 @@ namespace niji
         path() = default;
         
         explicit path(Alloc const& alloc) noexcept
-          : nodes_base(alloc), _index_tags(alloc)
+          : nodes_base(alloc), _verbs(alloc)
         {}
 
         path(path const& other, Alloc const& alloc)
           : nodes_base(other, alloc)
-          , _index_tags(other._index_tags, alloc)
+          , _verbs(other._verbs, alloc)
         {}
                 
         path(path&& other, Alloc const& alloc) noexcept
           : nodes_base(static_cast<nodes_base&&>(other), alloc)
-          , _index_tags(std::move(other._index_tags), alloc)
+          , _verbs(std::move(other._verbs), alloc)
         {}
 
         template<class Path, requires_valid<Path> = true>
         path(Path const& other, Alloc const& alloc = Alloc())
-          : nodes_base(alloc), _index_tags(alloc)
+          : nodes_base(alloc), _verbs(alloc)
         {
             add(other);
         }
         
         template<class Iter>
         path(Iter const& begin, Iter const& end, Alloc const& alloc = Alloc())
-          : nodes_base(begin, end, alloc) , _index_tags(alloc)
-        {}
+          : nodes_base(alloc), _verbs(alloc)
+        {
+            join(begin, end);
+        }
         
         path(std::initializer_list<Node> pts, Alloc const& alloc = Alloc())
-          : nodes_base(pts.begin(), pts.end(), alloc), _index_tags(alloc)
-        {}
+          : nodes_base(alloc), _verbs(alloc)
+        {
+            join(pts.begin(), pts.end());
+        }
 
         template<class Path>
         path& operator=(Path const& other)
@@ -189,43 +195,81 @@ namespace niji
         template<class Sink>
         void render(Sink& sink) const
         {
-            if (detail::path_render_impl(sink, static_cast<nodes_base const&>(*this), _index_tags))
-                sink(command::end_open);
+            detail::batch_render<Node>(sink, [this](auto& sink)
+            {
+                if (detail::verb_render_impl(sink, _verbs.begin(), _verbs.end(), nodes_base::begin()))
+                    sink(command::end_open);
+            });
         }
         
         template<class Sink>
         void inverse_render(Sink& sink) const
         {
-            namespace rng = ::boost::adaptors;
-            using namespace command;
-
-            char tag = end_tag::open;
-            bool needs_ending = detail::path_render_impl
-            (
-                sink
-              , rng::reverse(static_cast<nodes_base const&>(*this))
-              , rng::transform(rng::reverse(_index_tags),
-                    index_tag_t::remap(nodes_base::size(), tag))
-            );
-            if (needs_ending)
+            detail::batch_render<Node>(sink, [this](auto& sink)
             {
-                if (tag == end_tag::closed)
-                    sink(end_closed);
+                detail::verb_inverse_render_impl(sink, _verbs.begin(), _verbs.end(), nodes_base::end());
+            });
+        }
+
+        // Renders the nodes mapped by f, which transforms the points in bulk
+        // (see transforms::affine::transform_n), a chunk at a time. Each
+        // contiguous block of the deque within the chunk is mapped at once,
+        // the chunk is then passed as a batch if the sink accepts it, or
+        // replayed otherwise.
+        template<class Sink, class F, class R = typename F::result_type>
+        auto render_transformed(Sink& sink, F const& f) const ->
+            decltype(f.transform_n((Node const*)nullptr, size(), (R*)nullptr))
+        {
+            constexpr std::size_t chunk = 256;
+
+            R buf[chunk];
+            auto it = nodes_base::begin();
+            char const* vit = _verbs.data();
+            char const* const vend = vit + _verbs.size();
+            while (vit != vend)
+            {
+                char const* vbegin = vit;
+                std::size_t n = 0;
+                for ( ; vit != vend; ++vit)
+                {
+                    auto k = detail::verb::nodes(*vit);
+                    if (n + k > chunk)
+                        break;
+                    n += k;
+                }
+                for (std::size_t i = 0; i != n; )
+                {
+                    std::size_t const k = std::min<std::size_t>(n - i, it.get_last() - it.get_cur());
+                    f.transform_n(std::addressof(*it), k, buf + i);
+                    it += k;
+                    i += k;
+                }
+                if constexpr (detail::is_batch_sink<Sink, R>::value)
+                    sink(command::batch, verb_range(vbegin, vit), point_range<R>(buf, buf + n));
                 else
-                    sink(end_open);
+                    detail::verb_render_impl(sink, vbegin, vit, static_cast<R const*>(buf));
             }
+            if (!is_ended())
+                sink(command::end_open);
         }
 
         // Modofiers
         //----------------------------------------------------------------------
         void join(Node const& v)
         {
+            _verbs.push_back(is_ended() ? detail::verb::move : detail::verb::line);
             nodes_base::push_back(v);
         }
         
         template<class Iter>
         void join(Iter const& begin, Iter const& end)
         {
+            auto n = std::distance(begin, end);
+            if (!n)
+                return;
+            _verbs.reserve(_verbs.size() + n);
+            _verbs.push_back(is_ended() ? detail::verb::move : detail::verb::line);
+            _verbs.insert(_verbs.end(), n - 1, detail::verb::line);
             nodes_base::insert(nodes_base::end(), begin, end);
         }
 
@@ -278,42 +322,21 @@ namespace niji
         template<class Point, class A>
         void splice(path<Point, A> const& p)
         {
-            auto offset = nodes_base::size();
-            join(p.begin(), p.end());
-            _index_tags.reserve(_index_tags.size() + p._index_tags.size());
-            for (auto const& i : p._index_tags)
-                _index_tags.emplace_back(i.index + offset, i.tag);
+            detail::verb_splice(_verbs, p._verbs.begin(), p._verbs.end());
+            nodes_base::insert(nodes_base::end(), p.begin(), p.end());
         }
 
         template<class Point, class A>
         void reverse_splice(path<Point, A> const& p)
         {
-            auto offset = nodes_base::size();
-            join(p.rbegin(), p.rend());
-            
-            auto rit = p._index_tags.end(), rend = p._index_tags.begin();
-            if (rit != rend)
-            {
-                _index_tags.reserve(_index_tags.size() + (rit - rend));
-                char tag = end_tag::open | 4;
-                auto remap = index_tag_t::remap(p.size(), tag);
-                auto i = remap(*--rit);
-                if (i.index)
-                    _index_tags.emplace_back(i.index + offset, i.tag & 3);
-                while (rit != rend)
-                {
-                    i = remap(*--rit);
-                    _index_tags.emplace_back(i.index + offset, i.tag & 3);
-                }
-                if (!(tag & 4))
-                    delimit(static_cast<end_tag>(tag));
-            }
+            detail::verb_reverse_splice(_verbs, p._verbs.begin(), p._verbs.end());
+            nodes_base::insert(nodes_base::end(), p.rbegin(), p.rend());
         }
         
         void unsafe_quad_to(Node const& pt1, Node const& pt2)
         {
             BOOST_ASSERT(!is_ended());
-            _index_tags.emplace_back(nodes_base::size(), 2);
+            _verbs.push_back(detail::verb::quad);
             nodes_base::push_back(pt1);
             nodes_base::push_back(pt2);
         }
@@ -321,7 +344,7 @@ namespace niji
         void unsafe_cubic_to(Node const& pt1, Node const& pt2, Node const& pt3)
         {
             BOOST_ASSERT(!is_ended());
-            _index_tags.emplace_back(nodes_base::size(), 3);
+            _verbs.push_back(detail::verb::cubic);
             nodes_base::push_back(pt1);
             nodes_base::push_back(pt2);
             nodes_base::push_back(pt3);
@@ -339,42 +362,62 @@ namespace niji
 
         void delimit(end_tag tag)
         {
-            if (auto index = nodes_base::size())
-            {
-                if (_index_tags.empty() || _index_tags.back().index != index)
-                    _index_tags.emplace_back(index, tag);
-            }
+            if (!is_ended())
+                _verbs.push_back(tag);
         }
 
         void reopen()
         {
-            if (!_index_tags.empty() &&
-                _index_tags.back().index == nodes_base::size())
-                _index_tags.pop_back();
+            if (!_verbs.empty() && detail::verb::is_end(_verbs.back()))
+                _verbs.pop_back();
         }
         
         void clear() noexcept
         {
             nodes_base::clear();
-            _index_tags.clear();
+            _verbs.clear();
         }
 
         void swap(path& other) noexcept
         {
             nodes_base::swap(other);
-            _index_tags.swap(other._index_tags);
+            _verbs.swap(other._verbs);
         }
         
+        // Version 0 stored the index tags in place of the verbs, which are
+        // not converted. The loaded verbs are checked against the nodes.
         template<class Archive>
         void serialize(Archive& ar, unsigned version)
         {
-            ar & _index_tags & *static_cast<nodes_base*>(this);
+            using boost::archive::archive_exception;
+
+            if (Archive::is_loading::value && version < 1)
+                throw archive_exception(archive_exception::unsupported_class_version);
+            ar & _verbs & *static_cast<nodes_base*>(this);
+            if (Archive::is_loading::value &&
+                !detail::verb::check(_verbs.begin(), _verbs.end(), nodes_base::size()))
+            {
+                clear();
+                throw archive_exception(archive_exception::input_stream_error, "invalid path verbs");
+            }
         }
 
     private:
 
-        index_tag_container _index_tags;
+        verb_container _verbs;
     };
 }
 
+namespace boost { namespace serialization
+{
+    // Version 1 stores the verbs.
+    template<class Node, class Alloc>
+    struct version<niji::path<Node, Alloc>>
+    {
+        using type = mpl::int_<1>;
+        using tag = mpl::integral_c_tag;
+        BOOST_STATIC_CONSTANT(int, value = type::value);
+    };
+}}
+
 #endif
\ No newline at end of file
@@ -13,6 +13,15 @@ namespace niji
 {
     template<class Node, class Alloc = std::allocator<Node>>
     class path;
+
+    template<class Node, class Alloc = std::allocator<Node>>
+    class flat_path;
+
+    template<class T>
+    class measured_path;
+
+    template<class T>
+    class lod_path;
 }
 
 #endif
\ No newline at end of file
@@ -10,6 +10,7 @@
 #include <type_traits>
 #include <niji/render.hpp>
 #include <niji/sink/any.hpp>
+#include <niji/support/batch.hpp>
 
 namespace niji
 {
@@ -27,10 +28,14 @@ namespace niji
         static void f(void const* p, sink_t& sink, bool positive)
         {
             auto& path = *static_cast<Path const*>(p);
-            if (positive)
-                niji::render(path, sink);
-            else
-                niji::inverse_render(path, sink);
+            // The commands are passed in batches to save the indirect calls.
+            detail::batch_render<Point>(sink, [&](auto& sink)
+            {
+                if (positive)
+                    niji::render(path, sink);
+                else
+                    niji::inverse_render(path, sink);
+            });
         }
         
     public:
@@ -0,0 +1,416 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+#ifndef NIJI_PREPARED_PATH_HPP_INCLUDED
+#define NIJI_PREPARED_PATH_HPP_INCLUDED
+
+#include <cmath>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <boost/optional/optional.hpp>
+#include <boost/numeric/conversion/bounds.hpp>
+#include <boost/iterator/function_output_iterator.hpp>
+#include <boost/geometry/index/rtree.hpp>
+#include <boost/geometry/algorithms/comparable_distance.hpp>
+#include <boost/geometry/strategies/cartesian/distance_pythagoras_point_box.hpp>
+#include <niji/path.hpp>
+#include <niji/render.hpp>
+#include <niji/support/box.hpp>
+#include <niji/support/point.hpp>
+#include <niji/support/vector.hpp>
+#include <niji/support/bezier.hpp>
+#include <niji/algorithm/contains.hpp>
+
+namespace niji { namespace detail
+{
+    // A segment monotonic in y, `kind` is the number of points.
+    template<class T>
+    struct mono_segment
+    {
+        point<T> pts[4];
+        std::size_t index;
+        char kind;
+
+        box<point<T>> control_box() const
+        {
+            point<T> lo(pts[0]), hi(pts[0]);
+            for (int i = 1; i != kind; ++i)
+            {
+                lo.x = std::min(lo.x, pts[i].x);
+                lo.y = std::min(lo.y, pts[i].y);
+                hi.x = std::max(hi.x, pts[i].x);
+                hi.y = std::max(hi.y, pts[i].y);
+            }
+            return {lo, hi};
+        }
+
+        point<T> eval(T t) const
+        {
+            switch (kind)
+            {
+            case 2:
+                return points::interpolate(pts[0], pts[1], t);
+            case 3:
+                return {bezier::quad_eval(pts[0].x, pts[1].x, pts[2].x, t),
+                        bezier::quad_eval(pts[0].y, pts[1].y, pts[2].y, t)};
+            default:
+                return {bezier::cubic_eval(pts[0].x, pts[1].x, pts[2].x, pts[3].x, t),
+                        bezier::cubic_eval(pts[0].y, pts[1].y, pts[2].y, pts[3].y, t)};
+            }
+        }
+
+        // Returns the squared distance and sets the closest point, exact up
+        // to the rounding. For a quad, dot(B(t) - pt, B'(t)) = 0 is a cubic
+        // to solve. A cubic is bisected, the pieces whose control boxes are
+        // farther than the best so far are pruned, and on the flat ones, the
+        // projection on the chord is refined by Newton's method.
+        T closest(point<T> const& pt, point<T>& on) const
+        {
+            T best = boost::numeric::bounds<T>::highest();
+            auto test = [&](T t)
+            {
+                point<T> const p(eval(t));
+                T const d = vectors::norm_square(pt - p);
+                if (d < best)
+                {
+                    best = d;
+                    on = p;
+                }
+            };
+            test(0);
+            test(1);
+            switch (kind)
+            {
+            case 2:
+            {
+                vector<T> v(pts[1] - pts[0]);
+                T len2 = vectors::norm_square(v);
+                if (len2 > 0)
+                    test(std::min(std::max(vectors::dot(pt - pts[0], v) / len2, T(0)), T(1)));
+                break;
+            }
+            case 3:
+            {
+                vector<T> const a(pts[1] - pts[0]), b(pts[2] - pts[1] - a), c(pts[0] - pt);
+                T ts[3];
+                T* const end = solve_cubic_poly(vectors::dot(b, b), 3 * vectors::dot(a, b),
+                    2 * vectors::dot(a, a) + vectors::dot(c, b), vectors::dot(c, a), ts);
+                for (T* it = ts; it != end; ++it)
+                    test(*it);
+                break;
+            }
+            default:
+            {
+                vector<T> const d(box_extent(pts));
+                T const tol = (std::abs(d.x) + std::abs(d.y)) * T(1) / (1 << 16);
+                closest_cubic(pts, 0, 1, pt, tol * tol, best, test, 0);
+            }
+            }
+            return best;
+        }
+
+        int winding(point<T> const& pt, int& on_curve_count) const
+        {
+            switch (kind)
+            {
+            case 2:
+                return winding_line(pts, pt, on_curve_count);
+            case 3:
+                return winding_mono_quad(pts, pt, on_curve_count);
+            default:
+                return winding_mono_cubic(pts, pt, on_curve_count);
+            }
+        }
+
+        static vector<T> box_extent(point<T> const* p)
+        {
+            T lx = p[0].x, hx = lx, ly = p[0].y, hy = ly;
+            for (int i = 1; i != 4; ++i)
+            {
+                lx = std::min(lx, p[i].x);
+                hx = std::max(hx, p[i].x);
+                ly = std::min(ly, p[i].y);
+                hy = std::max(hy, p[i].y);
+            }
+            return {hx - lx, hy - ly};
+        }
+
+        // The squared distance from pt to the control box, which bounds the
+        // distance to the curve.
+        static T box_distance(point<T> const* p, point<T> const& pt)
+        {
+            T lx = p[0].x, hx = lx, ly = p[0].y, hy = ly;
+            for (int i = 1; i != 4; ++i)
+            {
+                lx = std::min(lx, p[i].x);
+                hx = std::max(hx, p[i].x);
+                ly = std::min(ly, p[i].y);
+                hy = std::max(hy, p[i].y);
+            }
+            T const dx = std::max({lx - pt.x, pt.x - hx, T(0)});
+            T const dy = std::max({ly - pt.y, pt.y - hy, T(0)});
+            return dx * dx + dy * dy;
+        }
+
+        // `p` is the piece of the cubic over [t0, t1].
+        template<class Test>
+        void closest_cubic(point<T> const* p, T t0, T t1, point<T> const& pt, T tol2, T const& best, Test& test, unsigned depth) const
+        {
+            vector<T> const chord(p[3] - p[0]);
+            T const len2 = vectors::norm_square(chord);
+            T const c1 = vectors::cross(chord, p[1] - p[0]), c2 = vectors::cross(chord, p[2] - p[0]);
+            if (depth == 32 || (c1 * c1 <= tol2 * len2 && c2 * c2 <= tol2 * len2 &&
+                vectors::dot(chord, p[1] - p[0]) >= 0 && vectors::dot(chord, p[3] - p[2]) >= 0))
+            {
+                T s = len2 > 0 ? std::min(std::max(vectors::dot(pt - p[0], chord) / len2, T(0)), T(1)) : T(0);
+                test(refine(pt, t0, t1, t0 + s * (t1 - t0)));
+                return;
+            }
+            point<T> half[7];
+            bezier::chop_cubic_at_half(p, half);
+            T const tm = (t0 + t1) / 2;
+            T const d0 = box_distance(half, pt), d1 = box_distance(half + 3, pt);
+            // The nearer half first, so the farther one is more likely pruned.
+            if (d1 < d0)
+            {
+                if (d1 < best)
+                    closest_cubic(half + 3, tm, t1, pt, tol2, best, test, depth + 1);
+                if (d0 < best)
+                    closest_cubic(half, t0, tm, pt, tol2, best, test, depth + 1);
+            }
+            else
+            {
+                if (d0 < best)
+                    closest_cubic(half, t0, tm, pt, tol2, best, test, depth + 1);
+                if (d1 < best)
+                    closest_cubic(half + 3, tm, t1, pt, tol2, best, test, depth + 1);
+            }
+        }
+
+        // Newton's method on f(t) = dot(B(t) - pt, B'(t)) within [t0, t1].
+        T refine(point<T> const& pt, T t0, T t1, T t) const
+        {
+            vector<T> const c(3 * (pts[1] - pts[0]));
+            vector<T> const b(3 * (pts[2] - pts[1]) - c);
+            vector<T> const a(pts[3] - pts[0] - c - b);
+            for (int i = 0; i != 4; ++i)
+            {
+                vector<T> const d1((3 * a * t + 2 * b) * t + c), d2(6 * a * t + 2 * b);
+                vector<T> const v(eval(t) - pt);
+                T const df = vectors::dot(d1, d1) + vectors::dot(v, d2);
+                if (!(df > 0))
+                    break;
+                T const next = std::min(std::max(t - vectors::dot(v, d1) / df, t0), t1);
+                if (next == t)
+                    break;
+                t = next;
+            }
+            return t;
+        }
+    };
+
+    // Splits the segments the same way as contains_sink.
+    template<class T>
+    struct prepare_sink
+    {
+        std::vector<mono_segment<T>>& segments;
+        point<T> _first, _pt0;
+        std::size_t _index;
+
+        void operator()(move_to_t, point<T> const& pt)
+        {
+            _first = _pt0 = pt;
+        }
+
+        void operator()(line_to_t, point<T> const& pt1)
+        {
+            push(&_pt0, 2);
+            segments.back().pts[1] = pt1;
+            next(pt1);
+        }
+
+        void operator()(quad_to_t, point<T> const& pt1, point<T> const& pt2)
+        {
+            point<T> pts[3] = {_pt0, pt1, pt2}, dst[5];
+            int n = 0;
+            point<T> const* src = pts;
+            if (!bezier::is_mono_quad(pts[0].y, pts[1].y, pts[2].y))
+            {
+                n = bezier::chop_quad_at_extrema<1>(pts, dst);
+                src = dst;
+            }
+            for (int i = 0; i <= n; ++i)
+                push(src + i * 2, 3);
+            next(pt2);
+        }
+
+        void operator()(cubic_to_t, point<T> const& pt1, point<T> const& pt2, point<T> const& pt3)
+        {
+            point<T> pts[4] = {_pt0, pt1, pt2, pt3}, dst[10];
+            int n = bezier::chop_cubic_at_extrema<1>(pts, dst);
+            for (int i = 0; i <= n; ++i)
+                push(dst + i * 3, 4);
+            next(pt3);
+        }
+
+        void operator()(end_open_t) {}
+
+        void operator()(end_closed_t)
+        {
+            operator()(line_to_t{}, _first);
+        }
+
+        void push(point<T> const* pts, char kind)
+        {
+            mono_segment<T> seg;
+            std::copy(pts, pts + kind, seg.pts);
+            seg.index = _index;
+            seg.kind = kind;
+            segments.push_back(seg);
+        }
+
+        void next(point<T> const& pt)
+        {
+            _pt0 = pt;
+            ++_index;
+        }
+    };
+}}
+
+namespace niji
+{
+    // A path prepared for queries, the segments are split into monotonic ones
+    // and indexed by an R-tree, so contains, nearest & pick are logarithmic.
+    template<class T>
+    class prepared_path
+    {
+        using segment_t = detail::mono_segment<T>;
+        using box_t = box<point<T>>;
+        using value_t = std::pair<box_t, std::size_t>;
+        using rtree_t = boost::geometry::index::rtree<value_t, boost::geometry::index::rstar<16>>;
+
+    public:
+
+        using point_type = point<T>;
+
+        // `segment` is the ordinal of the segment in the path, counting the
+        // closing line of closed figures.
+        struct hit
+        {
+            std::size_t segment;
+            point<T> position;
+            T distance;
+        };
+
+        prepared_path() = default;
+
+        template<class Path>
+        explicit prepared_path(Path const& path)
+          : _path(path)
+        {
+            detail::prepare_sink<T> sink{_segments};
+            sink._index = 0;
+            niji::render(_path, sink);
+            std::vector<value_t> values;
+            values.reserve(_segments.size());
+            for (std::size_t i = 0; i != _segments.size(); ++i)
+                values.emplace_back(_segments[i].control_box(), i);
+            _rtree = rtree_t(values);
+        }
+
+        template<class Sink>
+        void render(Sink& sink) const
+        {
+            _path.render(sink);
+        }
+
+        template<class Sink>
+        void inverse_render(Sink& sink) const
+        {
+            _path.inverse_render(sink);
+        }
+
+        // Same result as niji::contains on the original path.
+        bool contains(point<T> const& pt) const
+        {
+            namespace bgi = boost::geometry::index;
+
+            // Only the segments on the left can be crossed by the ray, the
+            // margin covers the on-curve test of numeric::is_nearly_zero.
+            box_t ray(point<T>(boost::numeric::bounds<T>::lowest(), pt.y),
+                point<T>(pt.x + T(1) / (1 << 12), pt.y));
+            int winding = 0, on_curve_count = 0;
+            _rtree.query(bgi::intersects(ray), boost::make_function_output_iterator([&](value_t const& v)
+            {
+                winding += _segments[v.second].winding(pt, on_curve_count);
+            }));
+            return detail::contains_result(winding, on_curve_count);
+        }
+
+        boost::optional<hit> nearest(point<T> const& pt) const
+        {
+            namespace bgi = boost::geometry::index;
+
+            // The segment of the nearest box bounds the search radius.
+            boost::optional<hit> ret;
+            auto it = _rtree.qbegin(bgi::nearest(pt, 1));
+            if (it != _rtree.qend())
+            {
+                T best = boost::numeric::bounds<T>::highest();
+                test(pt, it->second, best, ret);
+                search(pt, ret->distance, best, ret);
+            }
+            return ret;
+        }
+
+        // Finds the nearest segment within the distance r.
+        boost::optional<hit> pick(point<T> const& pt, T r) const
+        {
+            boost::optional<hit> ret;
+            T best = r * r;
+            search(pt, r, best, ret);
+            return ret;
+        }
+
+        std::size_t size() const
+        {
+            return _segments.size();
+        }
+
+    private:
+
+        void search(point<T> const& pt, T r, T& best, boost::optional<hit>& ret) const
+        {
+            namespace bgi = boost::geometry::index;
+
+            box_t area(point<T>(pt.x - r, pt.y - r), point<T>(pt.x + r, pt.y + r));
+            _rtree.query(bgi::intersects(area), boost::make_function_output_iterator([&](value_t const& v)
+            {
+                test(pt, v.second, best, ret);
+            }));
+        }
+
+        void test(point<T> const& pt, std::size_t i, T& best, boost::optional<hit>& ret) const
+        {
+            using std::sqrt;
+
+            point<T> on;
+            T d = _segments[i].closest(pt, on);
+            if (d <= best && (!ret || d < best || _segments[i].index < ret->segment))
+            {
+                best = d;
+                ret = hit{_segments[i].index, on, sqrt(d)};
+            }
+        }
+
+        path<point<T>> _path;
+        std::vector<segment_t> _segments;
+        rtree_t _rtree;
+    };
+}
+
+#endif
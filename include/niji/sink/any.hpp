@@ -8,6 +8,7 @@
 #define NIJI_SINK_ANY_HPP_INCLUDED
 
 #include <niji/support/command.hpp>
+#include <niji/support/batch.hpp>
 
 namespace niji { namespace any_sink_detail
 {
@@ -36,6 +37,16 @@ namespace niji { namespace any_sink_detail
         {
             (*static_cast<F*>(p))(std::forward<Ts>(ts)...);
         }
+
+        template<class Point>
+        static void f(void* p, batch_t, verb_range const& verbs, point_range<Point> const& pts)
+        {
+            auto& sink = *static_cast<F*>(p);
+            if constexpr (detail::is_batch_sink<F, Point>::value)
+                sink(command::batch, verbs, pts);
+            else
+                replay(sink, verbs, pts);
+        }
     };
 }}
 
@@ -44,18 +55,14 @@ namespace niji
     template<class Point>
     struct any_sink
     {
+        using accepts_batch = void;
+
         template<class Sink>
         any_sink(Sink& sink)
           : _sink(&sink)
           , _f(any_sink_detail::vgen<Sink>())
         {}
 
-        template<class Tag, class... Points>
-        void operator()(Tag tag, Points const&... pts) const
-        {
-            _f(_sink, tag, pts...);
-        }
-        
         void* _sink;
         any_sink_detail::vtable
         <
@@ -65,7 +72,14 @@ namespace niji
           , void(void*, cubic_to_t, Point const&, Point const&, Point const&)
           , void(void*, end_open_t)
           , void(void*, end_closed_t)
+          , void(void*, batch_t, verb_range const&, point_range<Point> const&)
         > _f;
+
+        template<class Tag, class... Points>
+        auto operator()(Tag tag, Points const&... pts) const -> decltype(_f(_sink, tag, pts...))
+        {
+            _f(_sink, tag, pts...);
+        }
     };
 }
 
@@ -59,7 +59,7 @@ namespace niji
             
             out << tag.str;
             (print_pt(out))(pt);
-            out << std::endl;
+            out << '\n';
         }
 
         template<class Point>
@@ -68,7 +68,7 @@ namespace niji
             out << "quad_to";
             print_pt print(out);
             print(pt1), print(pt2);
-            out << std::endl;
+            out << '\n';
         }
         
         template<class Point>
@@ -77,7 +77,7 @@ namespace niji
             out << "cubic_to";
             print_pt print(out);
             print(pt1), print(pt2), print(pt3);
-            out << std::endl;
+            out << '\n';
         }
  
         void operator()(end_open_t)
@@ -0,0 +1,458 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+#ifndef NIJI_SINK_RASTER_HPP_INCLUDED
+#define NIJI_SINK_RASTER_HPP_INCLUDED
+
+#include <cmath>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <climits>
+#include <algorithm>
+#include <niji/support/command.hpp>
+#include <niji/support/point.hpp>
+#include <niji/support/bezier.hpp>
+#include <niji/support/fill_rule.hpp>
+#include <niji/support/tolerance.hpp>
+
+// Define NIJI_NO_SIMD to use the scalar code only.
+#if !defined(NIJI_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#   define NIJI_RASTER_SSE2
+#   include <emmintrin.h>
+#endif
+
+namespace niji { namespace detail
+{
+    inline float raster_coverage(float a, bool evenodd)
+    {
+        a = std::abs(a);
+        if (evenodd)
+        {
+            a -= 2 * std::floor(a * 0.5f);
+            a = std::min(a, 2 - a);
+        }
+        return std::min(a, 1.f);
+    }
+
+    // Resolves the first n cells of the accumulation to the coverage, and
+    // returns the sum.
+    inline float raster_resolve(float const* acc, std::uint8_t* out, unsigned n, bool evenodd)
+    {
+        unsigned i = 0;
+        float sum = 0;
+#ifdef NIJI_RASTER_SSE2
+        __m128 const sign = _mm_set1_ps(-0.f);
+        __m128 const half = _mm_set1_ps(0.5f);
+        __m128 const one = _mm_set1_ps(1.f);
+        __m128 const two = _mm_set1_ps(2.f);
+        __m128 const scale = _mm_set1_ps(255.f);
+        __m128 offset = _mm_setzero_ps();
+        for ( ; i + 4 <= n; i += 4)
+        {
+            // The prefix sum within the register, then the carry.
+            __m128 x = _mm_loadu_ps(acc + i);
+            x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 4)));
+            x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 8)));
+            x = _mm_add_ps(x, offset);
+            offset = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3));
+            __m128 a = _mm_andnot_ps(sign, x);
+            if (evenodd)
+            {
+                __m128 f = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(a, half)));
+                a = _mm_sub_ps(a, _mm_mul_ps(f, two));
+                a = _mm_min_ps(a, _mm_sub_ps(two, a));
+            }
+            a = _mm_min_ps(a, one);
+            __m128i c = _mm_cvtps_epi32(_mm_mul_ps(a, scale));
+            c = _mm_packs_epi32(c, c);
+            c = _mm_packus_epi16(c, c);
+            std::uint32_t v = static_cast<std::uint32_t>(_mm_cvtsi128_si32(c));
+            std::memcpy(out + i, &v, 4);
+        }
+        sum = _mm_cvtss_f32(offset);
+#endif
+        // lrint rounds half to even as _mm_cvtps_epi32 does, so that the
+        // tail matches the SIMD lanes.
+        for ( ; i != n; ++i)
+        {
+            sum += acc[i];
+            out[i] = static_cast<std::uint8_t>(std::lrint(raster_coverage(sum, evenodd) * 255));
+        }
+        return sum;
+    }
+
+    // The accumulation of the signed area of a width x height canvas, see
+    // raster_sink.
+    class raster_cells
+    {
+        struct span
+        {
+            int min, max;
+        };
+
+    public:
+
+        raster_cells(unsigned width, unsigned height)
+          : _width(), _height(), _ymin(INT_MAX), _ymax(-1)
+        {
+            reset(width, height);
+        }
+
+        // Changes the size, must be clear.
+        void reset(unsigned width, unsigned height)
+        {
+            _width = width;
+            _height = height;
+            _acc.resize(std::size_t(width + 2) * height);
+            _spans.resize(height, span{INT_MAX, -1});
+        }
+
+        unsigned width() const
+        {
+            return _width;
+        }
+
+        unsigned height() const
+        {
+            return _height;
+        }
+
+        // Adds the value to the cell, x is in [0, width + 1].
+        void add(int x, int y, float val)
+        {
+            _acc[y * std::size_t(_width + 2) + x] += val;
+            span& s = _spans[y];
+            s.min = std::min(s.min, x);
+            s.max = std::max(s.max, x);
+            _ymin = std::min(_ymin, y);
+            _ymax = std::max(_ymax, y);
+        }
+
+        // Writes the coverage of the touched spans and clears them. The rest
+        // of the row is filled if a span leaves a coverage, e.g. by add.
+        void resolve(std::uint8_t* data, std::ptrdiff_t stride, bool evenodd)
+        {
+            std::size_t const row = _width + 2;
+            for (int y = _ymin; y <= _ymax; ++y)
+            {
+                span& s = _spans[y];
+                if (s.max < 0)
+                    continue;
+                float* acc = _acc.data() + y * row;
+                std::uint8_t* out = data + y * stride;
+                int end = std::min(s.max + 1, int(_width));
+                if (s.min < end)
+                {
+                    float sum = raster_resolve(acc + s.min, out + s.min, unsigned(end - s.min), evenodd);
+                    auto c = static_cast<std::uint8_t>(std::lround(raster_coverage(sum, evenodd) * 255));
+                    if (c)
+                        std::fill(out + end, out + _width, c);
+                }
+                std::fill(acc + s.min, acc + s.max + 1, 0.f);
+                s = span{INT_MAX, -1};
+            }
+            _ymin = INT_MAX;
+            _ymax = -1;
+        }
+
+        // Clips the line to [0, height] vertically, the parts outside touch
+        // no rows, then to [0, width] horizontally, the parts outside
+        // become vertical at the edges, which keeps the winding. It's done
+        // in the precision of the input, so the coordinates far off the
+        // canvas are fine, only the clipped ones are converted.
+        template<class U>
+        void line(U x0, U y0, U x1, U y1)
+        {
+            U const h = U(_height);
+            if (y0 == y1 || std::max(y0, y1) <= 0 || std::min(y0, y1) >= h)
+                return;
+            if (std::min(y0, y1) < 0 || std::max(y0, y1) > h)
+            {
+                U const dxdy = (x1 - x0) / (y1 - y0);
+                auto clamp = [&](U& x, U& y)
+                {
+                    U const yc = std::min(std::max(y, U(0)), h);
+                    if (yc != y)
+                    {
+                        x = x0 + (yc - y0) * dxdy;
+                        y = yc;
+                    }
+                };
+                clamp(x0, y0);
+                clamp(x1, y1);
+            }
+            U const w = U(_width);
+            // Clipped from left to right, but drawn in the original direction.
+            bool const rtl = x0 > x1;
+            if (rtl)
+            {
+                std::swap(x0, x1);
+                std::swap(y0, y1);
+            }
+            auto piece = [this, rtl](U xa, U ya, U xb, U yb)
+            {
+                if (rtl)
+                    draw(float(xb), float(yb), float(xa), float(ya));
+                else
+                    draw(float(xa), float(ya), float(xb), float(yb));
+            };
+            if (x1 <= 0 || x0 >= w)
+            {
+                U x = x1 <= 0 ? U(0) : w;
+                return piece(x, y0, x, y1);
+            }
+            U const dydx = (y1 - y0) / (x1 - x0);
+            if (x0 < 0)
+            {
+                U y = y0 - x0 * dydx;
+                piece(0, y0, 0, y);
+                x0 = 0, y0 = y;
+            }
+            U xe = x1, ye = y1;
+            if (x1 > w)
+            {
+                ye = y0 + (w - x0) * dydx;
+                xe = w;
+            }
+            piece(x0, y0, xe, ye);
+            if (x1 > w)
+                piece(w, ye, w, y1);
+        }
+
+    private:
+
+        // Accumulates the signed area of the line within [0, width].
+        void draw(float x0, float y0, float x1, float y1)
+        {
+            if (y0 == y1)
+                return;
+            float dir = 1;
+            if (y0 > y1)
+            {
+                std::swap(x0, x1);
+                std::swap(y0, y1);
+                dir = -1;
+            }
+            float const dxdy = (x1 - x0) / (y1 - y0);
+            if (y0 < 0)
+            {
+                x0 -= y0 * dxdy;
+                y0 = 0;
+            }
+            int const ybegin = int(y0);
+            int const yend = std::min(int(_height), int(std::ceil(y1)));
+            if (ybegin >= yend)
+                return;
+            _ymin = std::min(_ymin, ybegin);
+            _ymax = std::max(_ymax, yend - 1);
+            std::size_t const row = _width + 2;
+            float const w = float(_width);
+            // x is evaluated from the start for each row rather than stepped,
+            // which would drift along the long edges.
+            float x = x0;
+            for (int y = ybegin; y != yend; ++y)
+            {
+                float* acc = _acc.data() + y * row;
+                float const ynext = std::min(float(y + 1), y1);
+                float const dy = ynext - std::max(float(y), y0);
+                float const xnext = ynext == y1 ? x1 : x0 + dxdy * (ynext - y0);
+                float const d = dy * dir;
+                float xa = x, xb = xnext;
+                if (xa > xb)
+                    std::swap(xa, xb);
+                // Guard the rounding errors of the clipped lines.
+                xa = std::min(std::max(xa, 0.f), w);
+                xb = std::min(std::max(xb, xa), w);
+                float const xafloor = std::floor(xa);
+                int const xai = int(xafloor);
+                float const xbceil = std::ceil(xb);
+                int xbi = int(xbceil);
+                span& s = _spans[y];
+                s.min = std::min(s.min, xai);
+                if (xbi <= xai + 1)
+                {
+                    // Within a cell.
+                    float const xmf = 0.5f * (xa + xb) - xafloor;
+                    acc[xai] += d - d * xmf;
+                    acc[xai + 1] += d * xmf;
+                    s.max = std::max(s.max, xai + 1);
+                }
+                else
+                {
+                    float const r = 1 / (xb - xa);
+                    float const xaf = xa - xafloor;
+                    float const a0 = 0.5f * r * (1 - xaf) * (1 - xaf);
+                    float const xbf = xb - xbceil + 1;
+                    float const am = 0.5f * r * xbf * xbf;
+                    acc[xai] += d * a0;
+                    if (xbi == xai + 2)
+                        acc[xai + 1] += d * (1 - a0 - am);
+                    else
+                    {
+                        float const a1 = r * (1.5f - xaf);
+                        acc[xai + 1] += d * (a1 - a0);
+                        for (int xi = xai + 2; xi < xbi - 1; ++xi)
+                            acc[xi] += d * r;
+                        float const a2 = a1 + (xbi - xai - 3) * r;
+                        acc[xbi - 1] += d * (1 - a2 - am);
+                    }
+                    acc[xbi] += d * am;
+                    s.max = std::max(s.max, xbi);
+                }
+                x = xnext;
+            }
+        }
+
+        unsigned _width, _height;
+        std::vector<float> _acc;
+        std::vector<span> _spans;
+        int _ymin, _ymax;
+    };
+
+    // Approximates the curve by lines within the tolerance, see flatten_view.
+    template<class T, class F>
+    void raster_quad(point<T> const& pt0, point<T> const& pt1, point<T> const& pt2, T tolerance, F&& line)
+    {
+        unsigned n = bezier::quad_segments(pt0, pt1, pt2, tolerance);
+        point<T> prev = pt0;
+        for (unsigned i = 1; i != n; ++i)
+        {
+            T t = T(i) / n;
+            point<T> pt(
+                bezier::quad_eval(pt0.x, pt1.x, pt2.x, t),
+                bezier::quad_eval(pt0.y, pt1.y, pt2.y, t));
+            line(prev, pt);
+            prev = pt;
+        }
+        line(prev, pt2);
+    }
+
+    template<class T, class F>
+    void raster_cubic(point<T> const& pt0, point<T> const& pt1, point<T> const& pt2, point<T> const& pt3, T tolerance, F&& line)
+    {
+        unsigned n = bezier::cubic_segments(pt0, pt1, pt2, pt3, tolerance);
+        point<T> prev = pt0;
+        for (unsigned i = 1; i != n; ++i)
+        {
+            T t = T(i) / n;
+            point<T> pt(
+                bezier::cubic_eval(pt0.x, pt1.x, pt2.x, pt3.x, t),
+                bezier::cubic_eval(pt0.y, pt1.y, pt2.y, pt3.y, t));
+            line(prev, pt);
+            prev = pt;
+        }
+        line(prev, pt3);
+    }
+}}
+
+namespace niji
+{
+    // Rasterizes the filled paths into an 8-bit anti-aliased coverage mask,
+    // the figures are implicitly closed. The curves are flattened within the
+    // tolerance, the coordinates are in pixels.
+    //
+    // The signed area of the edges is accumulated in the cells, the coverage
+    // is then the prefix sum along the row (the technique of font-rs), and
+    // the even-odd coverage is folded from it. Only the touched spans of
+    // each row are resolved.
+    //
+    // The mask is written by flush, the untouched pixels are left as is, so
+    // the buffer should be cleared first.
+    template<class T>
+    class raster_sink
+    {
+    public:
+
+        using point_type = point<T>;
+
+        raster_sink(std::uint8_t* data, unsigned width, unsigned height, std::ptrdiff_t stride,
+            fill_rule rule = fill_rule::nonzero, T tolerance = T(NIJI_DEVICE_TOLERANCE))
+          : _data(data), _stride(stride), _rule(rule), _tolerance(tolerance)
+          , _cells(width, height), _open()
+        {}
+
+        void operator()(move_to_t, point_type const& pt)
+        {
+            close();
+            _start = _prev = pt;
+            _open = true;
+        }
+
+        void operator()(line_to_t, point_type const& pt)
+        {
+            line(_prev, pt);
+            _prev = pt;
+        }
+
+        void operator()(quad_to_t, point_type const& pt1, point_type const& pt2)
+        {
+            detail::raster_quad(_prev, pt1, pt2, _tolerance, line_fn());
+            _prev = pt2;
+        }
+
+        void operator()(cubic_to_t, point_type const& pt1, point_type const& pt2, point_type const& pt3)
+        {
+            detail::raster_cubic(_prev, pt1, pt2, pt3, _tolerance, line_fn());
+            _prev = pt3;
+        }
+
+        void operator()(end_tag)
+        {
+            close();
+        }
+
+        // Writes the coverage of the touched pixels and clears the
+        // accumulation for reuse.
+        void flush()
+        {
+            close();
+            _cells.resolve(_data, _stride, _rule == fill_rule::evenodd);
+        }
+
+        fill_rule rule() const
+        {
+            return _rule;
+        }
+
+        void rule(fill_rule rule)
+        {
+            _rule = rule;
+        }
+
+    private:
+
+        void close()
+        {
+            if (_open)
+            {
+                line(_prev, _start);
+                _open = false;
+            }
+        }
+
+        void line(point_type const& p0, point_type const& p1)
+        {
+            _cells.line(p0.x, p0.y, p1.x, p1.y);
+        }
+
+        auto line_fn()
+        {
+            return [this](point_type const& p0, point_type const& p1) { line(p0, p1); };
+        }
+
+        std::uint8_t* _data;
+        std::ptrdiff_t _stride;
+        fill_rule _rule;
+        T _tolerance;
+        detail::raster_cells _cells;
+        point_type _start, _prev;
+        bool _open;
+    };
+}
+
+#endif
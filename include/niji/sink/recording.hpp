@@ -0,0 +1,141 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+#ifndef NIJI_SINK_RECORDING_HPP_INCLUDED
+#define NIJI_SINK_RECORDING_HPP_INCLUDED
+
+#include <memory>
+#include <boost/container/vector.hpp>
+#include <boost/container/allocator_traits.hpp>
+#include <niji/support/command.hpp>
+#include <niji/support/batch.hpp>
+#include <niji/detail/verb.hpp>
+
+namespace niji
+{
+    // Records the commands verbatim as verbs (see detail::verb) & points in
+    // flat buffers, and replays them when rendered. Unlike path::sink, the
+    // stream is not normalized, e.g. an unended figure stays unended.
+    //
+    // It accepts batches, which are appended in bulk, and a sink accepting
+    // batches gets the whole recording in one batch.
+    template<class Point, class Alloc = std::allocator<Point>>
+    class recording_sink
+    {
+        using verb_alloc_t =
+            typename boost::container::allocator_traits<Alloc>::template
+                portable_rebind_alloc<char>::type;
+
+    public:
+
+        using point_type = Point;
+        using accepts_batch = void;
+
+        recording_sink() = default;
+
+        explicit recording_sink(Alloc const& alloc) noexcept
+          : _verbs(alloc), _points(alloc)
+        {}
+
+        void operator()(move_to_t, Point const& pt)
+        {
+            push(detail::verb::move, pt);
+        }
+
+        void operator()(line_to_t, Point const& pt)
+        {
+            push(detail::verb::line, pt);
+        }
+
+        void operator()(quad_to_t, Point const& pt1, Point const& pt2)
+        {
+            _verbs.push_back(detail::verb::quad);
+            _points.push_back(pt1);
+            _points.push_back(pt2);
+        }
+
+        void operator()(cubic_to_t, Point const& pt1, Point const& pt2, Point const& pt3)
+        {
+            _verbs.push_back(detail::verb::cubic);
+            _points.push_back(pt1);
+            _points.push_back(pt2);
+            _points.push_back(pt3);
+        }
+
+        void operator()(end_tag tag)
+        {
+            _verbs.push_back(tag);
+        }
+
+        void operator()(batch_t, verb_range const& verbs, point_range<Point> const& pts)
+        {
+            _verbs.insert(_verbs.end(), verbs.begin(), verbs.end());
+            _points.insert(_points.end(), pts.begin(), pts.end());
+        }
+
+        template<class Sink>
+        void render(Sink& sink) const
+        {
+            if constexpr (detail::is_batch_sink<Sink, Point>::value)
+            {
+                if (!_verbs.empty())
+                {
+                    sink(command::batch, verb_range(_verbs.data(), _verbs.data() + _verbs.size()),
+                        point_range<Point>(_points.data(), _points.data() + _points.size()));
+                }
+            }
+            else
+                detail::verb_render_impl(sink, _verbs.begin(), _verbs.end(), _points.begin());
+        }
+
+        verb_range verbs() const
+        {
+            return {_verbs.data(), _verbs.data() + _verbs.size()};
+        }
+
+        point_range<Point> points() const
+        {
+            return {_points.data(), _points.data() + _points.size()};
+        }
+
+        bool empty() const
+        {
+            return _verbs.empty();
+        }
+
+        void reserve(std::size_t verbs, std::size_t points)
+        {
+            _verbs.reserve(verbs);
+            _points.reserve(points);
+        }
+
+        // Keeps the capacity for reuse.
+        void clear() noexcept
+        {
+            _verbs.clear();
+            _points.clear();
+        }
+
+        void swap(recording_sink& other) noexcept
+        {
+            _verbs.swap(other._verbs);
+            _points.swap(other._points);
+        }
+
+    private:
+
+        void push(char v, Point const& pt)
+        {
+            _verbs.push_back(v);
+            _points.push_back(pt);
+        }
+
+        boost::container::vector<char, verb_alloc_t> _verbs;
+        boost::container::vector<Point, Alloc> _points;
+    };
+}
+
+#endif
@@ -7,10 +7,71 @@
 #ifndef NIJI_SINK_SVG_HPP_INCLUDED
 #define NIJI_SINK_SVG_HPP_INCLUDED
 
+#include <cmath>
+#include <charconv>
 #include <iostream>
+#include <algorithm>
 #include <boost/geometry/core/access.hpp>
 #include <niji/support/command.hpp>
 
+namespace niji { namespace detail
+{
+    // Writes q * 10^-precision without the trailing zeros.
+    inline char* svg_fixed_chars(char* p, long long q, int precision, bool compact)
+    {
+        if (!q)
+        {
+            *p++ = '0';
+            return p;
+        }
+        unsigned long long u = q;
+        if (q < 0)
+        {
+            *p++ = '-';
+            u = 0 - u;
+        }
+        char digits[24];
+        int n = int(std::to_chars(digits, digits + 24, u).ptr - digits);
+        int frac = precision;
+        while (frac && digits[n - 1] == '0')
+            --n, --frac;
+        int whole = n - frac;
+        if (whole > 0)
+            p = std::copy(digits, digits + whole, p);
+        else if (!compact)
+            *p++ = '0';
+        if (frac)
+        {
+            *p++ = '.';
+            for ( ; whole < 0; ++whole)
+                *p++ = '0';
+            p = std::copy(digits + whole, digits + n, p);
+        }
+        return p;
+    }
+
+    // Writes the shortest representation that round-trips.
+    template<class T>
+    char* svg_shortest_chars(char* p, T val, bool compact)
+    {
+        if (val == 0)
+        {
+            *p++ = '0';
+            return p;
+        }
+        char* const first = p;
+        p = std::to_chars(p, p + 32, val).ptr;
+        if (compact)
+        {
+            // "0.5" => ".5", "-0.5" => "-.5".
+            char* zero = first + (*first == '-');
+            if (zero[0] == '0' && zero + 1 != p && zero[1] == '.')
+                p = std::copy(zero + 1, p, zero);
+        }
+        return p;
+    }
+}}
+
 namespace niji
 {
     template<class Ostream>
@@ -62,6 +123,217 @@ namespace niji
     };
     
     using svg_sink = basic_svg_sink<std::ostream>;
+
+    struct svg_format
+    {
+        // Digits after the decimal point, or negative for the shortest
+        // representation that round-trips.
+        int precision = -1;
+        // Uses the relative command where it's shorter.
+        bool relative = false;
+        // Omits the repeated command letters & the unneeded separators, and
+        // uses H/V for the axis-aligned lines.
+        bool compact = false;
+    };
+
+    // Writes the SVG path data to the output iterator with std::to_chars,
+    // independent of the locale. The coordinates are converted to T.
+    //
+    // With a precision, the coordinates are rounded to the ticks of
+    // 10^-precision first, so the relative commands don't accumulate the
+    // rounding errors; the ticks must fit in long long.
+    template<class OutIt, class T = double>
+    class basic_svg_writer
+    {
+        // The ticks are used with a precision, otherwise the value.
+        struct coord
+        {
+            long long q;
+            T v;
+        };
+
+        // Enough for the digits of long long with the padding zeros of the
+        // maximum precision, or the shortest T.
+        static constexpr int max_precision = 17;
+        static constexpr int max_chars = 48;
+
+    public:
+
+        explicit basic_svg_writer(OutIt out, svg_format const& fmt = {})
+          : _out(out), _fmt(fmt), _scale(1), _cur(), _start()
+          , _letter(), _last_dot()
+        {
+            _fmt.precision = std::min(_fmt.precision, max_precision);
+            for (int i = 0; i < _fmt.precision; ++i)
+                _scale *= 10;
+        }
+
+        template<class Point>
+        void operator()(move_to_t, Point const& pt)
+        {
+            using boost::geometry::get;
+            coord cs[2] = {encode(get<0>(pt)), encode(get<1>(pt))};
+            // The subsequent pairs are implicit lines.
+            emit('M', cs, xy, 2);
+            _letter = _letter == 'M' ? 'L' : 'l';
+            _start[0] = _cur[0];
+            _start[1] = _cur[1];
+        }
+
+        template<class Point>
+        void operator()(line_to_t, Point const& pt)
+        {
+            using boost::geometry::get;
+            coord cs[2] = {encode(get<0>(pt)), encode(get<1>(pt))};
+            if (_fmt.compact)
+            {
+                static constexpr unsigned char x[] = {0}, y[] = {1};
+                if (same(cs[1], _cur[1]))
+                    return emit('H', cs, x, 1);
+                if (same(cs[0], _cur[0]))
+                    return emit('V', cs + 1, y, 1);
+            }
+            emit('L', cs, xy, 2);
+        }
+
+        template<class Point>
+        void operator()(quad_to_t, Point const& pt1, Point const& pt2)
+        {
+            using boost::geometry::get;
+            coord cs[4] = {encode(get<0>(pt1)), encode(get<1>(pt1)),
+                encode(get<0>(pt2)), encode(get<1>(pt2))};
+            emit('Q', cs, xy, 4);
+        }
+
+        template<class Point>
+        void operator()(cubic_to_t, Point const& pt1, Point const& pt2, Point const& pt3)
+        {
+            using boost::geometry::get;
+            coord cs[6] = {encode(get<0>(pt1)), encode(get<1>(pt1)),
+                encode(get<0>(pt2)), encode(get<1>(pt2)),
+                encode(get<0>(pt3)), encode(get<1>(pt3))};
+            emit('C', cs, xy, 6);
+        }
+
+        void operator()(end_open_t) {}
+
+        void operator()(end_closed_t)
+        {
+            *_out++ = 'Z';
+            _letter = 'Z';
+            _cur[0] = _start[0];
+            _cur[1] = _start[1];
+        }
+
+        OutIt out() const
+        {
+            return _out;
+        }
+
+    private:
+
+        static constexpr unsigned char xy[] = {0, 1, 0, 1, 0, 1};
+
+        coord encode(T v) const
+        {
+            return {_fmt.precision < 0 ? 0 : std::llround(v * _scale), v};
+        }
+
+        bool same(coord const& a, coord const& b) const
+        {
+            return _fmt.precision < 0 ? a.v == b.v : a.q == b.q;
+        }
+
+        char* format(char* p, coord const& c) const
+        {
+            return _fmt.precision < 0 ?
+                detail::svg_shortest_chars(p, c.v, _fmt.compact) :
+                detail::svg_fixed_chars(p, c.q, _fmt.precision, _fmt.compact);
+        }
+
+        // A number can follow another without a separator if it starts
+        // with '-', or with '.' after a number with '.'.
+        bool needs_separator(bool last_dot, char c) const
+        {
+            return !_fmt.compact || !(c == '-' || (c == '.' && last_dot));
+        }
+
+        // Writes the numbers to p and returns the end, `dot` tells if the
+        // last one has a '.'.
+        char* put(char* p, coord const* cs, int n, bool& dot) const
+        {
+            for (int i = 0; i != n; ++i)
+            {
+                char num[max_chars];
+                char* const last = format(num, cs[i]);
+                if (i)
+                {
+                    if (!_fmt.compact)
+                        *p++ = i & 1 ? ',' : ' ';
+                    else if (needs_separator(dot, *num))
+                        *p++ = ' ';
+                }
+                dot = std::find(num, last, '.') != last && std::find(num, last, 'e') == last;
+                p = std::copy(num, last, p);
+            }
+            return p;
+        }
+
+        // The cost of the letter, or the separator if the letter is omitted.
+        int lead(char letter, char first) const
+        {
+            return !_fmt.compact || letter != _letter || needs_separator(_last_dot, first);
+        }
+
+        void emit(char letter, coord const* cs, unsigned char const* axes, int n)
+        {
+            char abs_buf[6 * max_chars], rel_buf[6 * max_chars];
+            coord rel[6];
+            bool dot = false, rel_dot = false, is_rel = false;
+            char* const abs_end = put(abs_buf, cs, n, dot);
+            char* buf = abs_buf;
+            char* end = abs_end;
+            if (_fmt.relative)
+            {
+                for (int i = 0; i != n; ++i)
+                {
+                    coord const& cur = _cur[axes[i]];
+                    rel[i] = {cs[i].q - cur.q, cs[i].v - cur.v};
+                }
+                char* const rel_end = put(rel_buf, rel, n, rel_dot);
+                char const rel_letter = letter + ('a' - 'A');
+                if ((rel_end - rel_buf) + lead(rel_letter, *rel_buf) < (abs_end - abs_buf) + lead(letter, *abs_buf))
+                {
+                    letter = rel_letter;
+                    buf = rel_buf, end = rel_end, dot = rel_dot;
+                    is_rel = true;
+                }
+            }
+            if (!_fmt.compact || letter != _letter)
+                *_out++ = letter;
+            else if (needs_separator(_last_dot, *buf))
+                *_out++ = ' ';
+            _out = std::copy(buf, end, _out);
+            _letter = letter;
+            _last_dot = dot;
+            // Follow what the reader gets, so the errors don't accumulate.
+            coord next[2] = {_cur[0], _cur[1]};
+            for (int i = 0; i != n; ++i)
+            {
+                coord& c = next[axes[i]];
+                c = is_rel ? coord{_cur[axes[i]].q + rel[i].q, _cur[axes[i]].v + rel[i].v} : cs[i];
+            }
+            _cur[0] = next[0];
+            _cur[1] = next[1];
+        }
+
+        OutIt _out;
+        svg_format _fmt;
+        T _scale;
+        coord _cur[2], _start[2];
+        char _letter;
+        bool _last_dot;
+    };
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,335 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+#ifndef NIJI_SINK_TILED_RASTER_HPP_INCLUDED
+#define NIJI_SINK_TILED_RASTER_HPP_INCLUDED
+
+#include <cmath>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <numeric>
+#include <algorithm>
+#include <exception>
+#include <condition_variable>
+#include <niji/support/command.hpp>
+#include <niji/support/point.hpp>
+#include <niji/support/bezier.hpp>
+#include <niji/sink/raster.hpp>
+#include <niji/algorithm/parallel_render.hpp>
+
+// Width & height of the tiles of tiled_rasterizer.
+#ifndef NIJI_RASTER_TILE_SIZE
+#   define NIJI_RASTER_TILE_SIZE 64
+#endif
+
+namespace niji
+{
+    // The same as raster_sink, but rasterizes the tiles of the canvas
+    // concurrently.
+    //
+    // The curves are chopped at the y-extrema as they come, and each
+    // segment is binned into the tiles overlapped by the bounds of its
+    // control points. The winding of the segments on the left of a tile,
+    // which the coverage depends on, is accumulated per scanline as the
+    // backdrop of the tile, so each tile only rasterizes its own bin.
+    template<class T>
+    class tiled_rasterizer
+    {
+        // A y-monotone line, quad or cubic.
+        struct segment
+        {
+            point<T> pts[4];
+            unsigned size;
+        };
+
+    public:
+
+        using point_type = point<T>;
+
+        tiled_rasterizer(std::uint8_t* data, unsigned width, unsigned height, std::ptrdiff_t stride,
+            fill_rule rule = fill_rule::nonzero, T tolerance = T(NIJI_DEVICE_TOLERANCE),
+            unsigned tile_size = NIJI_RASTER_TILE_SIZE)
+          : _data(data), _width(width), _height(height), _stride(stride)
+          , _rule(rule), _tolerance(tolerance), _tile(std::max(tile_size, 1u))
+          , _cols((width + _tile - 1) / _tile), _rows((height + _tile - 1) / _tile)
+          , _bins(std::size_t(_cols) * _rows), _backdrop(std::size_t(_cols + 1) * height)
+          , _open()
+        {}
+
+        void operator()(move_to_t, point_type const& pt)
+        {
+            close();
+            _start = _prev = pt;
+            _open = true;
+        }
+
+        void operator()(line_to_t, point_type const& pt)
+        {
+            point_type pts[2] = {_prev, pt};
+            bin(pts, 2);
+            _prev = pt;
+        }
+
+        void operator()(quad_to_t, point_type const& pt1, point_type const& pt2)
+        {
+            point_type src[3] = {_prev, pt1, pt2}, dst[5];
+            int n = bezier::chop_quad_at_extrema<1>(src, dst);
+            for (int i = 0; i <= n; ++i)
+                bin(dst + i * 2, 3);
+            _prev = pt2;
+        }
+
+        void operator()(cubic_to_t, point_type const& pt1, point_type const& pt2, point_type const& pt3)
+        {
+            point_type src[4] = {_prev, pt1, pt2, pt3}, dst[10];
+            int n = bezier::chop_cubic_at_extrema<1>(src, dst);
+            for (int i = 0; i <= n; ++i)
+                bin(dst + i * 3, 4);
+            _prev = pt3;
+        }
+
+        void operator()(end_tag)
+        {
+            close();
+        }
+
+        // Rasterizes the tiles by the `concurrency` workers started by
+        // `executor(task)`, and writes the coverage of the touched pixels
+        // like raster_sink::flush.
+        template<class Executor>
+        void flush(Executor&& executor, unsigned concurrency = std::max(std::thread::hardware_concurrency(), 1u))
+        {
+            close();
+            std::size_t const stride = _cols + 1;
+            for (unsigned y = 0; y != _height; ++y)
+            {
+                float* b = _backdrop.data() + y * stride;
+                std::partial_sum(b, b + _cols, b);
+            }
+
+            bool const evenodd = _rule == fill_rule::evenodd;
+            std::size_t const count = _bins.size();
+            std::atomic<std::size_t> next(0);
+            std::exception_ptr error;
+            std::mutex mutex;
+            std::condition_variable cond;
+            std::size_t running = 0;
+
+            auto fail = [&](std::exception_ptr e)
+            {
+                if (!error)
+                    error = e;
+                next = count;
+            };
+            auto worker = [&]
+            {
+                try
+                {
+                    detail::raster_cells cells(_tile, _tile);
+                    for (std::size_t i; (i = next++) < count; )
+                        render_tile(cells, i, evenodd);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    fail(std::current_exception());
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                --running;
+                cond.notify_all();
+            };
+
+            // The executor may run the worker inline, so it's not locked here.
+            try
+            {
+                for (std::size_t n = std::min<std::size_t>(std::max(concurrency, 1u), count); n; --n)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        ++running;
+                    }
+                    try
+                    {
+                        executor(worker);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        --running;
+                        throw;
+                    }
+                }
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                fail(std::current_exception());
+            }
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cond.wait(lock, [&] { return !running; });
+            }
+            clear();
+            if (error)
+                std::rethrow_exception(error);
+        }
+
+        // Uses a thread for each worker.
+        void flush()
+        {
+            detail::thread_executor executor;
+            flush(executor);
+        }
+
+        // Discards the binned segments.
+        void clear()
+        {
+            _segments.clear();
+            for (auto& b : _bins)
+                b.clear();
+            std::fill(_backdrop.begin(), _backdrop.end(), 0.f);
+        }
+
+        fill_rule rule() const
+        {
+            return _rule;
+        }
+
+        void rule(fill_rule rule)
+        {
+            _rule = rule;
+        }
+
+    private:
+
+        void close()
+        {
+            if (_open)
+            {
+                (*this)(command::line_to, _start);
+                _open = false;
+            }
+        }
+
+        void bin(point_type const* pts, unsigned n)
+        {
+            using std::floor;
+
+            T xmin = pts[0].x, xmax = xmin, ymin = pts[0].y, ymax = ymin;
+            for (unsigned i = 1; i != n; ++i)
+            {
+                xmin = std::min(xmin, pts[i].x);
+                xmax = std::max(xmax, pts[i].x);
+                ymin = std::min(ymin, pts[i].y);
+                ymax = std::max(ymax, pts[i].y);
+            }
+            if (ymin == ymax || !(ymax > 0 && ymin < T(_height) && xmin < T(_width)))
+                return;
+            // Clamped to the canvas before the conversions, the coordinates
+            // may be far off.
+            T const tile = T(_tile);
+            int const cb = int(floor(std::max(xmin, T(0)) / tile));
+            int const ce = std::min(int(floor(std::min(std::max(xmax, -tile), T(_width)) / tile)) + 1, int(_cols));
+            if (cb < ce)
+            {
+                int const rb = int(floor(std::max(ymin, T(0)) / tile));
+                int const re = std::min(int(floor(std::min(ymax, T(_height)) / tile)) + 1, int(_rows));
+                auto const index = static_cast<std::uint32_t>(_segments.size());
+                _segments.push_back(segment{{pts[0], pts[1], pts[n > 2 ? 2 : 1], pts[n - 1]}, n});
+                for (int r = rb; r < re; ++r)
+                {
+                    for (int c = cb; c < ce; ++c)
+                        _bins[r * _cols + c].push_back(index);
+                }
+            }
+            if (ce < int(_cols))
+                backdrop(float(pts[0].y), float(pts[n - 1].y), ce);
+        }
+
+        // The winding of the segment for the tiles from the column, as a
+        // vertical line.
+        void backdrop(float y0, float y1, unsigned col)
+        {
+            float dir = 1;
+            if (y0 > y1)
+            {
+                std::swap(y0, y1);
+                dir = -1;
+            }
+            y0 = std::max(y0, 0.f);
+            y1 = std::min(y1, float(_height));
+            std::size_t const stride = _cols + 1;
+            for (int y = int(y0), end = int(std::ceil(y1)); y < end; ++y)
+            {
+                float dy = std::min(float(y + 1), y1) - std::max(float(y), y0);
+                _backdrop[y * stride + col] += dir * dy;
+            }
+        }
+
+        void render_tile(detail::raster_cells& cells, std::size_t i, bool evenodd) const
+        {
+            unsigned const c = unsigned(i % _cols), r = unsigned(i / _cols);
+            unsigned const x0 = c * _tile, y0 = r * _tile;
+            unsigned const w = std::min(_tile, _width - x0), h = std::min(_tile, _height - y0);
+            std::size_t const stride = _cols + 1;
+            auto const& bin = _bins[i];
+            float const* b = _backdrop.data() + y0 * stride + c;
+            bool carry = false;
+            for (unsigned y = 0; y != h && !carry; ++y)
+                carry = b[y * stride] != 0;
+            if (bin.empty() && !carry)
+                return;
+            cells.reset(w, h);
+            for (unsigned y = 0; y != h; ++y)
+            {
+                if (float v = b[y * stride])
+                    cells.add(0, int(y), v);
+            }
+            T const ox = T(x0), oy = T(y0);
+            auto line = [&](point_type const& p0, point_type const& p1)
+            {
+                cells.line(p0.x, p0.y, p1.x, p1.y);
+            };
+            for (auto index : bin)
+            {
+                segment const& seg = _segments[index];
+                point_type pts[4];
+                for (unsigned k = 0; k != 4; ++k)
+                    pts[k] = point_type(seg.pts[k].x - ox, seg.pts[k].y - oy);
+                switch (seg.size)
+                {
+                case 2:
+                    line(pts[0], pts[3]);
+                    break;
+                case 3:
+                    detail::raster_quad(pts[0], pts[1], pts[3], _tolerance, line);
+                    break;
+                default:
+                    detail::raster_cubic(pts[0], pts[1], pts[2], pts[3], _tolerance, line);
+                }
+            }
+            cells.resolve(_data + y0 * _stride + x0, _stride, evenodd);
+        }
+
+        std::uint8_t* _data;
+        unsigned _width, _height;
+        std::ptrdiff_t _stride;
+        fill_rule _rule;
+        T _tolerance;
+        unsigned _tile, _cols, _rows;
+        std::vector<segment> _segments;
+        std::vector<std::vector<std::uint32_t>> _bins;
+        std::vector<float> _backdrop;
+        point_type _start, _prev;
+        bool _open;
+    };
+}
+
+#endif
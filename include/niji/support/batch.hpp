@@ -0,0 +1,171 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+#ifndef NIJI_SUPPORT_BATCH_HPP_INCLUDED
+#define NIJI_SUPPORT_BATCH_HPP_INCLUDED
+
+#include <cstddef>
+#include <type_traits>
+#include <boost/range/iterator_range_core.hpp>
+#include <niji/support/command.hpp>
+#include <niji/detail/verb.hpp>
+#include <niji/detail/enable_if_valid.hpp>
+
+// Max verbs in a batch made by batch_builder.
+#ifndef NIJI_BATCH_SIZE
+#   define NIJI_BATCH_SIZE 256
+#endif
+
+namespace niji
+{
+    // A batch is a slice of the command stream, i.e. `sink(batch, verbs, pts)`
+    // where the verbs are encoded as in detail::verb, each consumes its nodes
+    // in pts. A batch continues the figure of the previous one and is not
+    // implicitly ended.
+    //
+    // The sink opts in by having a nested `accepts_batch` type, since
+    // forwarding sinks usually accept any command tag.
+    using verb_range = boost::iterator_range<char const*>;
+
+    template<class Point>
+    using point_range = boost::iterator_range<Point const*>;
+
+    // Replays a batch as individual commands.
+    template<class Sink, class Point>
+    inline void replay(Sink& sink, verb_range const& verbs, point_range<Point> const& pts)
+    {
+        detail::verb_render_impl(sink, verbs.begin(), verbs.end(), pts.begin());
+    }
+}
+
+namespace niji { namespace detail
+{
+    template<class Sink, class Point, class = void>
+    struct is_batch_sink : std::false_type {};
+
+    template<class Sink, class Point>
+    struct is_batch_sink<Sink, Point, enable_if_valid_t<decltype(
+        std::declval<Sink&>()(command::batch, std::declval<verb_range>(), std::declval<point_range<Point>>())),
+        enable_if_valid_t<typename Sink::accepts_batch>>>
+      : std::true_type
+    {};
+
+    // Collects the commands and passes them to the sink in batches.
+    template<class Point, class Sink>
+    struct batch_builder
+    {
+        using accepts_batch = void;
+
+        static constexpr std::size_t capacity = NIJI_BATCH_SIZE;
+
+        explicit batch_builder(Sink& sink)
+          : _sink(sink), _verb_count(), _point_count()
+        {}
+
+        batch_builder(batch_builder const&) = delete;
+
+        ~batch_builder()
+        {
+            flush();
+        }
+
+        void operator()(move_to_t, Point const& pt)
+        {
+            reserve(1);
+            push(verb::move, pt);
+        }
+
+        void operator()(line_to_t, Point const& pt)
+        {
+            reserve(1);
+            push(verb::line, pt);
+        }
+
+        void operator()(quad_to_t, Point const& pt1, Point const& pt2)
+        {
+            reserve(2);
+            push(verb::quad, pt1);
+            _points[_point_count++] = pt2;
+        }
+
+        void operator()(cubic_to_t, Point const& pt1, Point const& pt2, Point const& pt3)
+        {
+            reserve(3);
+            push(verb::cubic, pt1);
+            _points[_point_count++] = pt2;
+            _points[_point_count++] = pt3;
+        }
+
+        void operator()(end_closed_t)
+        {
+            reserve(0);
+            _verbs[_verb_count++] = verb::closed;
+        }
+
+        void operator()(end_open_t)
+        {
+            reserve(0);
+            _verbs[_verb_count++] = verb::open;
+        }
+
+        void operator()(batch_t, verb_range const& verbs, point_range<Point> const& pts)
+        {
+            flush();
+            _sink(command::batch, verbs, pts);
+        }
+
+        void flush()
+        {
+            if (_verb_count)
+            {
+                _sink(command::batch, verb_range(_verbs, _verbs + _verb_count),
+                    point_range<Point>(_points, _points + _point_count));
+                _verb_count = _point_count = 0;
+            }
+        }
+
+    private:
+
+        void reserve(std::size_t n)
+        {
+            if (_verb_count == capacity || _point_count + n > capacity * 3)
+                flush();
+        }
+
+        void push(char v, Point const& pt)
+        {
+            _verbs[_verb_count++] = v;
+            _points[_point_count++] = pt;
+        }
+
+        Sink& _sink;
+        std::size_t _verb_count, _point_count;
+        char _verbs[capacity];
+        Point _points[capacity * 3];
+    };
+
+    template<class Sink>
+    struct is_batch_builder : std::false_type {};
+
+    template<class Point, class Sink>
+    struct is_batch_builder<batch_builder<Point, Sink>> : std::true_type {};
+
+    // Calls f with a sink that collects the commands in batches if the sink
+    // accepts batches, otherwise with the sink itself.
+    template<class Point, class Sink, class F>
+    inline void batch_render(Sink& sink, F&& f)
+    {
+        if constexpr (is_batch_sink<Sink, Point>::value && !is_batch_builder<Sink>::value)
+        {
+            batch_builder<Point, Sink> builder(sink);
+            f(builder);
+        }
+        else
+            f(sink);
+    }
+}}
+
+#endif
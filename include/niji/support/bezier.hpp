@@ -26,8 +26,23 @@
 // Some are from Pomax's excellent article about bezier, see
 // http://pomax.github.io/bezierinfo/.
 
-#define NIJI_MAX_QUAD_SUBDIVIDE 5
-#define NIJI_MAX_CUBIC_SUBDIVIDE 7
+// Default subdivision limits, used when no tolerance is given.
+#ifndef NIJI_MAX_QUAD_SUBDIVIDE
+#   define NIJI_MAX_QUAD_SUBDIVIDE 5
+#endif
+
+#ifndef NIJI_MAX_CUBIC_SUBDIVIDE
+#   define NIJI_MAX_CUBIC_SUBDIVIDE 7
+#endif
+
+// Upper bound of the subdivision limits derived from a tolerance.
+#ifndef NIJI_MAX_TOLERANCE_SUBDIVIDE
+#   define NIJI_MAX_TOLERANCE_SUBDIVIDE 16
+#endif
+
+#ifndef NIJI_MAX_FLATTEN_SEGMENTS
+#   define NIJI_MAX_FLATTEN_SEGMENTS 1024
+#endif
 
 namespace niji { namespace detail
 {
@@ -1045,23 +1060,40 @@ namespace niji { namespace bezier
         return it;
     }
 
+    // Number of halvings for `len` to be within the tolerance.
+    template<class T>
+    unsigned bisect_depth(T len, T tolerance)
+    {
+        unsigned depth = 1;
+        for ( ; len > tolerance && depth != NIJI_MAX_TOLERANCE_SUBDIVIDE; len /= 2)
+            ++depth;
+        return depth;
+    }
+
+    // Finds t where f(t) is within the tolerance of sum, in at most
+    // `subdivide` iterations. If the tolerance is not positive, 1/4096 is
+    // used, otherwise the iterations are bounded by the tolerance instead.
     template<class T, class F>
-    T curve_bisect(unsigned subdivide, T sum, T len, F&& f)
+    T curve_bisect(unsigned subdivide, T sum, T len, T tolerance, F&& f)
     {
+        if (tolerance > 0)
+            subdivide = bisect_depth(len, tolerance);
+        else
+            tolerance = T(1) / (1 << 12);
         T L = 0, R = len, left = 0, right = 1, t = sum / R, d;
         for (; ; --subdivide)
         {
             d = f(t);
             if (d < sum)
             {
-                if (numeric::is_nearly_zero(sum - d) || !subdivide)
+                if (sum - d <= tolerance || !subdivide)
                     break;
                 left = t;
                 L = d;
             }
             else
             {
-                if (numeric::is_nearly_zero(d - sum) || !subdivide)
+                if (d - sum <= tolerance || !subdivide)
                     break;
                 right = t;
                 R = d;
@@ -1070,6 +1102,73 @@ namespace niji { namespace bezier
         }
         return t;
     }
+
+    template<class T, class F>
+    T curve_bisect(unsigned subdivide, T sum, T len, F&& f)
+    {
+        return curve_bisect(subdivide, sum, len, T(0), f);
+    }
+
+    // Number of lines to approximate the curve within the tolerance, which
+    // is given analytically by Wang's formula:
+    // n = sqrt(d(d - 1) / 8 * max|P[i] - 2P[i + 1] + P[i + 2]| / tolerance)
+    template<class T>
+    unsigned flatten_segments(T k, T tolerance)
+    {
+        using std::sqrt;
+        using std::ceil;
+
+        T n = ceil(sqrt(k / tolerance));
+        if (!(n < NIJI_MAX_FLATTEN_SEGMENTS)) // NaN-safe
+            return k > 0 ? NIJI_MAX_FLATTEN_SEGMENTS : 1;
+        return n < 1 ? 1 : static_cast<unsigned>(n);
+    }
+
+    template<class T>
+    unsigned quad_segments(point<T> const& pt1, point<T> const& pt2, point<T> const& pt3, T tolerance)
+    {
+        T dd = vectors::norm(pt1 - pt2 * 2 + pt3);
+        return flatten_segments(dd / 4, tolerance);
+    }
+
+    template<class T>
+    unsigned cubic_segments(point<T> const& pt1, point<T> const& pt2, point<T> const& pt3, point<T> const& pt4, T tolerance)
+    {
+        using std::max;
+
+        T dd = max(vectors::norm(pt1 - pt2 * 2 + pt3), vectors::norm(pt2 - pt3 * 2 + pt4));
+        return flatten_segments(dd * 3 / 4, tolerance);
+    }
+
+    // Number of halvings for the pieces to be flat within the tolerance, each
+    // halving quarters the flatness. If the tolerance is not positive,
+    // `subdivide` is returned.
+    template<class T>
+    unsigned subdivide_depth(unsigned subdivide, T k, T tolerance)
+    {
+        if (!(tolerance > 0))
+            return subdivide;
+        unsigned depth = 0;
+        for ( ; k > tolerance && depth != NIJI_MAX_TOLERANCE_SUBDIVIDE; k /= 4)
+            ++depth;
+        return depth;
+    }
+
+    template<class T>
+    unsigned quad_subdivide(point<T> const pts[3], T tolerance)
+    {
+        T dd = vectors::norm(pts[0] - pts[1] * 2 + pts[2]);
+        return subdivide_depth(NIJI_MAX_QUAD_SUBDIVIDE, dd / 4, tolerance);
+    }
+
+    template<class T>
+    unsigned cubic_subdivide(point<T> const pts[4], T tolerance)
+    {
+        using std::max;
+
+        T dd = max(vectors::norm(pts[0] - pts[1] * 2 + pts[2]), vectors::norm(pts[1] - pts[2] * 2 + pts[3]));
+        return subdivide_depth(NIJI_MAX_CUBIC_SUBDIVIDE, dd * 3 / 4, tolerance);
+    }
 }}
 
 #endif
\ No newline at end of file
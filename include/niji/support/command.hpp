@@ -40,6 +40,9 @@ namespace niji
     
     using quad_to_t = nth_curve_to_t<2>;
     using cubic_to_t = nth_curve_to_t<3>;
+
+    // See niji/support/batch.hpp.
+    struct batch_t {};
 }
 
 namespace niji { namespace command
@@ -52,6 +55,7 @@ namespace niji { namespace command
     NIJI_IDENTIFIER(line_to_t, line_to);
     NIJI_IDENTIFIER(quad_to_t, quad_to);
     NIJI_IDENTIFIER(cubic_to_t, cubic_to);
+    NIJI_IDENTIFIER(batch_t, batch);
 }}
 
 #endif
\ No newline at end of file
@@ -0,0 +1,19 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+#ifndef NIJI_SUPPORT_FILL_RULE_HPP_INCLUDED
+#define NIJI_SUPPORT_FILL_RULE_HPP_INCLUDED
+
+namespace niji
+{
+    enum class fill_rule
+    {
+        nonzero,
+        evenodd
+    };
+}
+
+#endif
@@ -0,0 +1,16 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+#ifndef NIJI_SUPPORT_TOLERANCE_HPP_INCLUDED
+#define NIJI_SUPPORT_TOLERANCE_HPP_INCLUDED
+
+// Default tolerance in the device space (e.g. pixels), used by the stroking
+// with a matrix, the rasterizer & lod_path.
+#ifndef NIJI_DEVICE_TOLERANCE
+#   define NIJI_DEVICE_TOLERANCE 0.25
+#endif
+
+#endif
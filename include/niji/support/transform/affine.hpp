@@ -7,6 +7,9 @@
 #ifndef NIJI_SUPPORT_TRANSFORM_AFFINE_HPP_INCLUDED
 #define NIJI_SUPPORT_TRANSFORM_AFFINE_HPP_INCLUDED
 
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
 #include <type_traits>
 #include <niji/support/traits.hpp>
 #include <niji/support/point.hpp>
@@ -369,6 +372,18 @@ namespace niji { namespace transforms
             return sx * sy - shy * shx;
         }
 
+        // The max factor a length is scaled by, i.e. the larger singular value.
+        // A tolerance in the device space divided by it is the one in the user
+        // space.
+        T max_scale() const
+        {
+            using std::sqrt;
+
+            T a = sx * sx + shx * shx + shy * shy + sy * sy;
+            T d = determinant();
+            return sqrt((a + sqrt(std::max(a * a - 4 * d * d, T(0)))) / 2);
+        }
+
         affine_inverse<affine const&> operator~() const&
         {
             return {*this};
@@ -387,6 +402,34 @@ namespace niji { namespace transforms
             auto x = get<0>(pt), y = get<1>(pt);
             return {sx * x + shx * y + tx, sy * y + shy * x + ty};
         }
+
+        // Bulk version over separate x & y arrays, the output may alias the
+        // input. The loop is kept plain so that it's auto-vectorized.
+        template<class U>
+        void transform_n(U const* xs, U const* ys, std::size_t n, T* out_xs, T* out_ys) const
+        {
+            T const a = sx, b = shx, c = tx, d = shy, e = sy, f = ty;
+            for (std::size_t i = 0; i != n; ++i)
+            {
+                T x = xs[i], y = ys[i];
+                out_xs[i] = a * x + b * y + c;
+                out_ys[i] = e * y + d * x + f;
+            }
+        }
+
+        // Bulk version over an array of points, e.g. a block of niji::path.
+        template<class Point>
+        void transform_n(Point const* pts, std::size_t n, point<T>* out) const
+        {
+            using boost::geometry::get;
+
+            T const a = sx, b = shx, c = tx, d = shy, e = sy, f = ty;
+            for (std::size_t i = 0; i != n; ++i)
+            {
+                T x = get<0>(pts[i]), y = get<1>(pts[i]);
+                out[i] = {a * x + b * y + c, e * y + d * x + f};
+            }
+        }
     };
 }}
 
@@ -0,0 +1,317 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+#ifndef NIJI_VIEW_CLIP_HPP_INCLUDED
+#define NIJI_VIEW_CLIP_HPP_INCLUDED
+
+#include <algorithm>
+#include <niji/support/view.hpp>
+#include <niji/support/command.hpp>
+#include <niji/support/point.hpp>
+#include <niji/support/box.hpp>
+#include <niji/support/numeric.hpp>
+#include <niji/support/bezier.hpp>
+#include <niji/sink/recording.hpp>
+#include <niji/detail/verb.hpp>
+
+namespace niji { namespace detail
+{
+    // The roots where the coordinates cross the lines of the box edges,
+    // sorted & within (0, 1).
+    template<class T, class Solve>
+    T* clip_roots(box<point<T>> const& b, Solve&& solve, T* out)
+    {
+        T* end = out;
+        end = solve(0, b.min_corner.x, end);
+        end = solve(0, b.max_corner.x, end);
+        end = solve(1, b.min_corner.y, end);
+        end = solve(1, b.max_corner.y, end);
+        end = std::remove_if(out, end, [](T t) { return !(0 < t && t < 1); });
+        std::sort(out, end);
+        return std::unique(out, end);
+    }
+
+    // 0 1 2
+    // 3 4 5
+    // 6 7 8
+    template<class T>
+    inline int clip_region(box<point<T>> const& b, point<T> const& pt)
+    {
+        int x = pt.x < b.min_corner.x ? 0 : pt.x > b.max_corner.x ? 2 : 1;
+        int y = pt.y < b.min_corner.y ? 0 : pt.y > b.max_corner.y ? 2 : 1;
+        return y * 3 + x;
+    }
+
+    template<class T>
+    inline point<T> clip_clamp(box<point<T>> const& b, point<T> const& pt)
+    {
+        return point<T>(
+            std::min(std::max(pt.x, b.min_corner.x), b.max_corner.x),
+            std::min(std::max(pt.y, b.min_corner.y), b.max_corner.y));
+    }
+}}
+
+namespace niji
+{
+    // Clips the figures to the box, for the fill inside the box:
+    //
+    // * The figures whose control bounds miss the box are dropped.
+    // * The figures within the box are passed through.
+    // * Otherwise the segments are cut where they cross the lines of the box
+    //   edges, the parts inside are kept, and the runs outside are replaced
+    //   by the lines along the box edges. That's the projection onto the box,
+    //   which keeps the winding of every point inside.
+    //
+    // The open figures are cut as if closed, since the fill closes them
+    // implicitly, the closing line is cut as well and followed by end_open.
+    // So for strokes, the outline should be clipped instead, i.e.
+    // `path | views::stroke(...) | views::clip(...)`.
+    template<class T>
+    struct clip_view : view<clip_view<T>>
+    {
+        template<class Path>
+        using point_type = point<T>;
+
+        box<point<T>> bounds;
+
+        explicit clip_view(box<point<T>> const& bounds) : bounds(bounds) {}
+
+        template<class Sink>
+        struct adaptor
+        {
+            using point_t = point<T>;
+
+            adaptor(Sink& sink, box<point_t> const& bounds)
+              : _sink(sink), _box(bounds), _region(-1)
+            {}
+
+            void operator()(move_to_t, point_t const& pt)
+            {
+                _fig.clear();
+                _fig(command::move_to, pt);
+                _min = _max = pt;
+            }
+
+            void operator()(line_to_t, point_t const& pt)
+            {
+                _fig(command::line_to, pt);
+                extend(pt);
+            }
+
+            void operator()(quad_to_t, point_t const& pt1, point_t const& pt2)
+            {
+                _fig(command::quad_to, pt1, pt2);
+                extend(pt1), extend(pt2);
+            }
+
+            void operator()(cubic_to_t, point_t const& pt1, point_t const& pt2, point_t const& pt3)
+            {
+                _fig(command::cubic_to, pt1, pt2, pt3);
+                extend(pt1), extend(pt2), extend(pt3);
+            }
+
+            template<end_tag E>
+            void operator()(end_tag_t<E> tag)
+            {
+                if (_max.x < _box.min_corner.x || _min.x > _box.max_corner.x ||
+                    _max.y < _box.min_corner.y || _min.y > _box.max_corner.y)
+                    return;
+                if (_min.x >= _box.min_corner.x && _max.x <= _box.max_corner.x &&
+                    _min.y >= _box.min_corner.y && _max.y <= _box.max_corner.y)
+                    _fig.render(_sink);
+                else
+                    clip();
+                _sink(tag);
+            }
+
+        private:
+
+            void extend(point_t const& pt)
+            {
+                _min.x = std::min(_min.x, pt.x);
+                _min.y = std::min(_min.y, pt.y);
+                _max.x = std::max(_max.x, pt.x);
+                _max.y = std::max(_max.y, pt.y);
+            }
+
+            void clip()
+            {
+                auto const verbs = _fig.verbs();
+                auto pts = _fig.points().begin();
+                point_t const start = *pts++;
+                point_t cur = start;
+                _last = detail::clip_clamp(_box, start);
+                _sink(command::move_to, _last);
+                for (auto it = verbs.begin() + 1; it != verbs.end(); ++it)
+                {
+                    switch (*it)
+                    {
+                    case detail::verb::line:
+                        line(cur, pts[0]);
+                        cur = pts[0];
+                        pts += 1;
+                        break;
+                    case detail::verb::quad:
+                        quad(cur, pts[0], pts[1]);
+                        cur = pts[1];
+                        pts += 2;
+                        break;
+                    case detail::verb::cubic:
+                        cubic(cur, pts[0], pts[1], pts[2]);
+                        cur = pts[2];
+                        pts += 3;
+                    }
+                }
+                // The closing line may cross the box as well, it's implied
+                // for the open figures too.
+                line(cur, start);
+                flush();
+            }
+
+            void line(point_t const& pt0, point_t const& pt1)
+            {
+                T roots[4];
+                auto end = detail::clip_roots(_box, [&](int i, T val, T* out)
+                {
+                    T a = i ? pt0.y : pt0.x, b = i ? pt1.y : pt1.x;
+                    return out + numeric::valid_unit_divide(val - a, b - a, *out);
+                }, roots);
+                point_t prev = pt0;
+                for (auto it = roots; ; ++it)
+                {
+                    point_t pt = it == end ? pt1 : points::interpolate(pt0, pt1, *it);
+                    piece(points::middle(prev, pt), pt, [&]
+                    {
+                        _sink(command::line_to, pt);
+                    });
+                    if (it == end)
+                        break;
+                    prev = pt;
+                }
+            }
+
+            void quad(point_t const& pt0, point_t const& pt1, point_t const& pt2)
+            {
+                T roots[8];
+                auto end = detail::clip_roots(_box, [&](int i, T val, T* out)
+                {
+                    return i ? bezier::quad_solve(pt0.y, pt1.y, pt2.y, val, out) :
+                        bezier::quad_solve(pt0.x, pt1.x, pt2.x, val, out);
+                }, roots);
+                point_t src[3] = {pt0, pt1, pt2}, dst[5];
+                T t0 = 0;
+                for (auto it = roots; ; ++it)
+                {
+                    T t;
+                    if (it == end || !numeric::valid_unit_divide(*it - t0, 1 - t0, t))
+                        std::copy(src, src + 3, dst);
+                    else
+                        bezier::chop_quad_at(src, dst, t);
+                    point_t const& a = dst[0];
+                    point_t const& b = dst[1];
+                    point_t const& c = dst[2];
+                    point_t mid((a.x + 2 * b.x + c.x) / 4, (a.y + 2 * b.y + c.y) / 4);
+                    piece(mid, c, [&]
+                    {
+                        _sink(command::quad_to, b, c);
+                    });
+                    if (it == end || dst[2] == src[2])
+                        break;
+                    std::copy(dst + 2, dst + 5, src);
+                    t0 = *it;
+                }
+            }
+
+            void cubic(point_t const& pt0, point_t const& pt1, point_t const& pt2, point_t const& pt3)
+            {
+                T roots[12];
+                auto end = detail::clip_roots(_box, [&](int i, T val, T* out)
+                {
+                    return i ? bezier::cubic_solve(pt0.y, pt1.y, pt2.y, pt3.y, val, out) :
+                        bezier::cubic_solve(pt0.x, pt1.x, pt2.x, pt3.x, val, out);
+                }, roots);
+                point_t src[4] = {pt0, pt1, pt2, pt3}, dst[3 * 12 + 4];
+                bezier::chop_cubic_at(src, dst, roots, end);
+                for (auto p = dst, last = dst + (end - roots) * 3; ; p += 3)
+                {
+                    point_t mid(
+                        (p[0].x + 3 * (p[1].x + p[2].x) + p[3].x) / 8,
+                        (p[0].y + 3 * (p[1].y + p[2].y) + p[3].y) / 8);
+                    piece(mid, p[3], [&]
+                    {
+                        _sink(command::cubic_to, p[1], p[2], p[3]);
+                    });
+                    if (p == last)
+                        break;
+                }
+            }
+
+            // The piece is either inside, or within a region outside.
+            template<class F>
+            void piece(point_t const& mid, point_t const& end, F&& emit)
+            {
+                int region = detail::clip_region(_box, mid);
+                if (region == 4)
+                {
+                    flush();
+                    emit();
+                    _last = end;
+                }
+                else
+                {
+                    // The run within a region is a line on the edge or the
+                    // corner.
+                    if (region != _region)
+                        flush();
+                    _region = region;
+                    _pending = detail::clip_clamp(_box, end);
+                }
+            }
+
+            void flush()
+            {
+                if (_region != -1)
+                {
+                    if (_pending != _last)
+                    {
+                        _sink(command::line_to, _pending);
+                        _last = _pending;
+                    }
+                    _region = -1;
+                }
+            }
+
+            Sink& _sink;
+            box<point_t> const& _box;
+            recording_sink<point_t> _fig;
+            point_t _min, _max, _last, _pending;
+            int _region;
+        };
+
+        template<class Path, class Sink>
+        void render(Path const& path, Sink& sink) const
+        {
+            niji::render(path, adaptor<Sink>{sink, bounds});
+        }
+
+        template<class Path, class Sink>
+        void inverse_render(Path const& path, Sink& sink) const
+        {
+            niji::inverse_render(path, adaptor<Sink>{sink, bounds});
+        }
+    };
+}
+
+namespace niji { namespace views
+{
+    template<class T>
+    inline clip_view<T> clip(box<point<T>> const& bounds)
+    {
+        return clip_view<T>{bounds};
+    }
+}}
+
+#endif
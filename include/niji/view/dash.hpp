@@ -7,9 +7,11 @@
 #ifndef NIJI_VIEW_DASH_HPP_INCLUDED
 #define NIJI_VIEW_DASH_HPP_INCLUDED
 
+#include <memory>
 #include <type_traits>
 #include <boost/assert.hpp>
 #include <boost/range/iterator.hpp>
+#include <niji/path_fwd.hpp>
 #include <niji/support/view.hpp>
 #include <niji/support/just.hpp>
 #include <niji/support/numeric.hpp>
@@ -17,8 +19,10 @@
 
 namespace niji
 {
-    template<class T, class Pattern, class U>
-    struct dash_view : view<dash_view<T, Pattern, U>>
+    // If `tolerance` is positive, the dashes on curves are located within it
+    // instead of the fixed iterations, see bezier::curve_bisect.
+    template<class T, class Pattern, class U, class Alloc = std::allocator<point<T>>>
+    struct dash_view : view<dash_view<T, Pattern, U, Alloc>>
     {
         template<class Path>
         using point_type = point<T>;
@@ -26,6 +30,8 @@ namespace niji
         Pattern pattern;
         T offset;
         U weight;
+        Alloc alloc;
+        T tolerance;
         
         template<class Sink>
         struct adaptor
@@ -64,14 +70,14 @@ namespace niji
                 boost::range_iterator<std::remove_reference_t<Pattern> const>::type;
     
             Sink& _sink;
-            detail::dasher<T, U, iterator_t> _dasher;
+            detail::dasher<T, U, iterator_t, Alloc> _dasher;
         };
         
         dash_view() = default;
         
-        explicit dash_view(Pattern pattern, T offset = {}, U weight = {})
+        explicit dash_view(Pattern pattern, T offset = {}, U weight = {}, Alloc const& alloc = Alloc(), T tolerance = 0)
           : pattern(std::forward<Pattern>(pattern))
-          , offset(offset), weight(weight)
+          , offset(offset), weight(weight), alloc(alloc), tolerance(tolerance)
         {}
 
         template<class Path, class Sink>
@@ -79,9 +85,18 @@ namespace niji
         {
             auto i = std::begin(pattern), e = std::end(pattern);
             if (i != e)
-                niji::render(path, adaptor<Sink>{sink, {i, e, offset, weight}});
+                niji::render(path, adaptor<Sink>{sink, {i, e, offset, weight, alloc, tolerance}});
         }
         
+        // The pre-measured path needs no length computation.
+        template<class T2, class Sink>
+        void render(measured_path<T2> const& path, Sink& sink) const
+        {
+            auto i = std::begin(pattern), e = std::end(pattern);
+            if (i != e)
+                path.dash(i, e, offset, weight, sink);
+        }
+
         template<class Path, class Sink>
         void inverse_render(Path const& path, Sink& sink) const
         {
@@ -97,6 +112,19 @@ namespace niji { namespace views
     {
         return dash_view<T, Pattern, U>{std::forward<Pattern>(p), offset, weight};
     }
+
+    template<class T, class Pattern = std::initializer_list<T> const&, class U>
+    inline auto dash(Pattern&& p, just_t<T> offset, U weight, just_t<T> tolerance)
+    {
+        return dash_view<T, Pattern, U>{std::forward<Pattern>(p), offset, weight, {}, tolerance};
+    }
+
+    template<class T, class Pattern = std::initializer_list<T> const&, class U, class Alloc,
+        std::enable_if_t<!std::is_arithmetic<Alloc>::value, bool> = true>
+    inline auto dash(Pattern&& p, just_t<T> offset, U weight, Alloc const& alloc, just_t<T> tolerance = {})
+    {
+        return dash_view<T, Pattern, U, Alloc>{std::forward<Pattern>(p), offset, weight, alloc, tolerance};
+    }
 }}
 
 #endif
\ No newline at end of file
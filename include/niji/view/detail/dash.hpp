@@ -8,6 +8,7 @@
 #define NIJI_VIEW_DETAIL_DASH_HPP_INCLUDED
 
 #include <cmath>
+#include <memory>
 #include <boost/assert.hpp>
 #include <boost/optional/optional.hpp>
 #include <niji/path.hpp>
@@ -18,15 +19,16 @@
 
 namespace niji { namespace detail
 {
-    template<class T, class U, class Iterator>
+    template<class T, class U, class Iterator, class Alloc = std::allocator<point<T>>>
     struct dasher
     {
         using point_t = point<T>;
         using vector_t = vector<T>;
+        using path_t = path<point_t, Alloc>;
         
-        dasher(Iterator const& begin, Iterator const& end, T offset, U weight)
-          : _begin(begin), _end(end), _it(begin)
-          , _offset(), _weight(weight), _skip(), _gap()
+        dasher(Iterator const& begin, Iterator const& end, T offset, U weight, Alloc const& alloc = Alloc(), T tolerance = 0)
+          : _path(alloc), _begin(begin), _end(end), _it(begin)
+          , _offset(), _tolerance(tolerance), _weight(weight), _skip(), _gap()
         {
             using std::fmod;
             
@@ -82,7 +84,7 @@ namespace niji { namespace detail
         void quad_to(point_t const& pt1, point_t const& pt2, Sink& sink)
         {
             T len(bezier::quad_length(_prev_pt, pt1, pt2));
-            quad_actor act{_path, {_prev_pt, pt1, pt2}};
+            quad_actor act{_path, {_prev_pt, pt1, pt2}, _tolerance};
             if (pre_act(act, len))
             {
                 flush(sink);
@@ -95,7 +97,7 @@ namespace niji { namespace detail
         void cubic_to(point_t const& pt1, point_t const& pt2, point_t const& pt3, Sink& sink)
         {
             T len(bezier::cubic_length(_prev_pt, pt1, pt2, pt3));
-            cubic_actor act{_path, {_prev_pt, pt1, pt2, pt3}};
+            cubic_actor act{_path, {_prev_pt, pt1, pt2, pt3}, _tolerance};
             if (pre_act(act, len))
             {
                 flush(sink);
@@ -173,7 +175,7 @@ namespace niji { namespace detail
         
         struct line_actor
         {
-            path<point_t>& _path;
+            path_t& _path;
             point_t _pts[2];
             point_t _chops[3];
 
@@ -201,8 +203,9 @@ namespace niji { namespace detail
 
         struct quad_actor
         {
-            path<point_t>& _path;
+            path_t& _path;
             point_t _pts[3];
+            T _tolerance;
             point_t _chops[5];
 
             void join_end(bool has_prev)
@@ -214,7 +217,7 @@ namespace niji { namespace detail
             
             void join(T sum, T len)
             {
-                bezier::curve_bisect(NIJI_MAX_QUAD_SUBDIVIDE, sum, len, [this](T t)
+                bezier::curve_bisect(NIJI_MAX_QUAD_SUBDIVIDE, sum, len, _tolerance, [this](T t)
                 {
                     bezier::chop_quad_at(_pts, _chops, t);
                     return bezier::quad_length(_chops[0], _chops[1], _chops[2]);
@@ -230,8 +233,9 @@ namespace niji { namespace detail
         
         struct cubic_actor
         {
-            path<point_t>& _path;
+            path_t& _path;
             point_t _pts[4];
+            T _tolerance;
             point_t _chops[7];
 
             void join_end(bool has_prev)
@@ -243,7 +247,7 @@ namespace niji { namespace detail
             
             void join(T sum, T len)
             {
-                bezier::curve_bisect(NIJI_MAX_CUBIC_SUBDIVIDE, sum, len, [this](T t)
+                bezier::curve_bisect(NIJI_MAX_CUBIC_SUBDIVIDE, sum, len, _tolerance, [this](T t)
                 {
                     bezier::chop_cubic_at(_pts, _chops, t);
                     return bezier::cubic_length(_chops[0], _chops[1], _chops[2], _chops[3]);
@@ -277,11 +281,12 @@ namespace niji { namespace detail
             _path.clear();
         }
 
-        path<point_t> _path;
+        path_t _path;
         Iterator const _begin, _end;
         Iterator _it;
         point_t _prev_pt, _first_pt;
         T _offset;
+        T const _tolerance;
         U _weight;
         bool _skip, _gap;
     };
@@ -7,34 +7,127 @@
 #ifndef NIJI_VIEW_DETAIL_OFFSET_OUTLINE_HPP_INCLUDED
 #define NIJI_VIEW_DETAIL_OFFSET_OUTLINE_HPP_INCLUDED
 
+#include <memory>
+#include <boost/assert.hpp>
 #include <niji/path.hpp>
 #include <niji/support/command.hpp>
 #include <niji/support/point.hpp>
 #include <niji/support/vector.hpp>
 #include <niji/support/bezier.hpp>
 
+// Number of outer nodes buffered before they're streamed to the sink.
+#ifndef NIJI_OUTLINE_STREAM_THRESHOLD
+#   define NIJI_OUTLINE_STREAM_THRESHOLD 64
+#endif
+
 namespace niji { namespace detail
 {
+    // Forwards the incomplete outer side to the sink, continuing the figure
+    // already started. If delayed, the last line node is held back since the
+    // joiner may still modify it.
+    template<class Sink, class Point>
+    struct outline_stream_sink
+    {
+        void operator()(move_to_t, Point const& pt)
+        {
+            emit_pending();
+            _sink(command::move_to, pt);
+            _started = true;
+            _leading = false;
+        }
+
+        void operator()(line_to_t, Point const& pt)
+        {
+            if (_leading)
+            {
+                _leading = false;
+                if (!_started)
+                {
+                    _sink(command::move_to, pt);
+                    _started = true;
+                    return;
+                }
+                if (_anchored)
+                    return;
+            }
+            emit_pending();
+            if (_delay)
+            {
+                _pending = pt;
+                _has_pending = true;
+            }
+            else
+                _sink(command::line_to, pt);
+        }
+
+        void operator()(quad_to_t, Point const& pt1, Point const& pt2)
+        {
+            emit_pending();
+            _sink(command::quad_to, pt1, pt2);
+        }
+
+        void operator()(cubic_to_t, Point const& pt1, Point const& pt2, Point const& pt3)
+        {
+            emit_pending();
+            _sink(command::cubic_to, pt1, pt2, pt3);
+        }
+
+        void operator()(end_closed_t)
+        {
+            emit_pending();
+            _sink(command::end_closed);
+            _started = false;
+        }
+
+        void operator()(end_open_t)
+        {
+            emit_pending();
+            _sink(command::end_open);
+            _started = false;
+        }
+
+        void emit_pending()
+        {
+            if (_has_pending)
+            {
+                _sink(command::line_to, _pending);
+                _has_pending = false;
+            }
+        }
+
+        Sink& _sink;
+        bool& _started;
+        bool _anchored;
+        bool _delay;
+        bool _leading = true;
+        bool _has_pending = false;
+        Point _pending;
+    };
+
     // This is used for both stroke & offset.
-    template<class T, class Joiner, bool DoInner = false>
+    template<class T, class Joiner, bool DoInner = false, class Alloc = std::allocator<point<T>>>
     struct offset_outline
     {
         using point_t = point<T>;
         using vector_t = vector<T>;
-        using path_t = path<point_t>;
+        using path_t = path<point_t, Alloc>;
 
         Joiner const& _join;
 
-        T _r, _pre_magnitude, _first_magnitude;
+        T _r, _tolerance, _pre_magnitude, _first_magnitude;
         path_t _outer, _inner/*, extra*/;
         point_t _prev_pt, _first_pt/*, first_outer_pt*/;
         vector_t _prev_normal, _first_normal;
         int _seg_count;
         bool _prev_is_line;
-
-        offset_outline(T r, Joiner const& join)
-            : _join(join), _r(r), _pre_magnitude(), _first_magnitude()
-            , _seg_count(), _prev_is_line()
+        bool _streamed, _anchored;
+
+        // If the tolerance is positive, the subdivision of curves is limited by
+        // it instead of NIJI_MAX_QUAD_SUBDIVIDE & NIJI_MAX_CUBIC_SUBDIVIDE.
+        offset_outline(T r, Joiner const& join, Alloc const& alloc = Alloc(), T tolerance = 0)
+            : _join(join), _r(r), _tolerance(tolerance), _pre_magnitude(), _first_magnitude()
+            , _outer(alloc), _inner(alloc)
+            , _seg_count(), _prev_is_line(), _streamed(), _anchored()
         {}
 
         void move_to_no_cap(point_t const& pt)
@@ -98,13 +191,13 @@ namespace niji { namespace detail
                     }
                     else
                     {
-                        quad_to_stroke(tmp, normalAB, normalBC, NIJI_MAX_QUAD_SUBDIVIDE);
+                        quad_to_stroke(tmp, normalAB, normalBC, bezier::quad_subdivide(tmp, _tolerance));
                         vector_t normal(normalBC);
-                        quad_to_stroke(tmp + 2, normal, normalBC, NIJI_MAX_QUAD_SUBDIVIDE);
+                        quad_to_stroke(tmp + 2, normal, normalBC, bezier::quad_subdivide(tmp + 2, _tolerance));
                     }
                 }
                 else
-                    quad_to_stroke(pts, normalAB, normalBC, NIJI_MAX_QUAD_SUBDIVIDE);
+                    quad_to_stroke(pts, normalAB, normalBC, bezier::quad_subdivide(pts, _tolerance));
             }
             post_join(pt2, normalBC);
         }
@@ -130,7 +223,7 @@ namespace niji { namespace detail
                 auto pos = tmp, end = tmp + 3 * count;
                 for (; pos != end; pos += 3)
                 {
-                    cubic_to_stroke(pos, normal, normalCD, NIJI_MAX_CUBIC_SUBDIVIDE);
+                    cubic_to_stroke(pos, normal, normalCD, bezier::cubic_subdivide(pos, _tolerance));
                     normal = normalCD;
                 }
             }
@@ -309,10 +402,35 @@ namespace niji { namespace detail
             }
         }
 
+        // Sends the outer side computed so far to the sink, only the last
+        // node is kept. The inner side has to be reversed so it's still
+        // buffered until the figure is finished.
+        template<class Sink>
+        void stream(Sink& sink)
+        {
+            if (_outer.size() < NIJI_OUTLINE_STREAM_THRESHOLD)
+                return;
+            point_t last(_outer.back());
+            outline_stream_sink<Sink, point_t> s{sink, _streamed, _anchored, true};
+            niji::render(_outer.incomplete(), s);
+            _outer.clear();
+            _anchored = !s._has_pending;
+            _outer.join(_anchored ? last : s._pending);
+        }
+
         template<class Sink>
         void finish(Sink& sink, bool reversed)
         {
-            if (reversed)
+            if (_streamed)
+            {
+                BOOST_ASSERT(!reversed);
+                outline_stream_sink<Sink, point_t> s{sink, _streamed, _anchored, false};
+                niji::render(_outer.incomplete(), s);
+                if (_streamed)
+                    sink(command::end_open);
+                _streamed = false;
+            }
+            else if (reversed)
                 _outer.inverse_render(sink);
             else
                 _outer.render(sink);
@@ -0,0 +1,90 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+#ifndef NIJI_VIEW_DETAIL_OUTLINE_REF_HPP_INCLUDED
+#define NIJI_VIEW_DETAIL_OUTLINE_REF_HPP_INCLUDED
+
+#include <niji/path.hpp>
+#include <niji/support/point.hpp>
+
+namespace niji { namespace detail
+{
+    // Refers to a path<point<T>, Alloc> of any Alloc, for the part the
+    // joiners & the cappers use. It lets join_style & cap_style be erased
+    // once and called with the scratch paths of any allocator.
+    template<class T>
+    class outline_ref
+    {
+        using point_t = point<T>;
+
+        struct vtable
+        {
+            void(*join)(void*, point_t const&);
+            void(*quad_to)(void*, point_t const&, point_t const&);
+            void(*cubic_to)(void*, point_t const&, point_t const&, point_t const&);
+            point_t&(*back)(void*);
+        };
+
+        template<class Path>
+        static vtable const* table()
+        {
+            static constexpr vtable vt =
+            {
+                [](void* p, point_t const& pt)
+                {
+                    static_cast<Path*>(p)->join(pt);
+                },
+                [](void* p, point_t const& pt1, point_t const& pt2)
+                {
+                    static_cast<Path*>(p)->unsafe_quad_to(pt1, pt2);
+                },
+                [](void* p, point_t const& pt1, point_t const& pt2, point_t const& pt3)
+                {
+                    static_cast<Path*>(p)->unsafe_cubic_to(pt1, pt2, pt3);
+                },
+                [](void* p) -> point_t&
+                {
+                    return static_cast<Path*>(p)->back();
+                }
+            };
+            return &vt;
+        }
+
+    public:
+
+        template<class Alloc>
+        outline_ref(path<point_t, Alloc>& p)
+          : _p(&p), _vt(table<path<point_t, Alloc>>())
+        {}
+
+        void join(point_t const& pt)
+        {
+            _vt->join(_p, pt);
+        }
+
+        void unsafe_quad_to(point_t const& pt1, point_t const& pt2)
+        {
+            _vt->quad_to(_p, pt1, pt2);
+        }
+
+        void unsafe_cubic_to(point_t const& pt1, point_t const& pt2, point_t const& pt3)
+        {
+            _vt->cubic_to(_p, pt1, pt2, pt3);
+        }
+
+        point_t& back()
+        {
+            return _vt->back(_p);
+        }
+
+    private:
+
+        void* _p;
+        vtable const* _vt;
+    };
+}}
+
+#endif
@@ -11,15 +11,15 @@
 
 namespace niji { namespace detail
 {
-    template<class T, class Joiner, class Capper>
-    struct stroker : offset_outline<T, Joiner, true>
+    template<class T, class Joiner, class Capper, class Alloc = std::allocator<point<T>>>
+    struct stroker : offset_outline<T, Joiner, true, Alloc>
     {
-        using base = offset_outline<T, Joiner, true>;
+        using base = offset_outline<T, Joiner, true, Alloc>;
 
         Capper const& _cap;
 
-        stroker(T r, Joiner const& join, Capper const& cap)
-          : base(r, join), _cap(cap)
+        stroker(T r, Joiner const& join, Capper const& cap, Alloc const& alloc = Alloc(), T tolerance = 0)
+          : base(r, join, alloc, tolerance), _cap(cap)
         {}
 
         void degenerated_dot()
@@ -0,0 +1,114 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+#ifndef NIJI_VIEW_FLATTEN_HPP_INCLUDED
+#define NIJI_VIEW_FLATTEN_HPP_INCLUDED
+
+#include <niji/support/view.hpp>
+#include <niji/support/just.hpp>
+#include <niji/support/command.hpp>
+#include <niji/support/point.hpp>
+#include <niji/support/bezier.hpp>
+
+namespace niji
+{
+    // Approximates the curves by lines within the tolerance, the number of
+    // lines for each curve is given by Wang's formula, see
+    // bezier::quad_segments & bezier::cubic_segments.
+    template<class T>
+    struct flatten_view : view<flatten_view<T>>
+    {
+        template<class Path>
+        using point_type = point<T>;
+
+        T tolerance;
+
+        explicit flatten_view(T tolerance) : tolerance(tolerance) {}
+
+        template<class Sink>
+        struct adaptor
+        {
+            using point_t = point<T>;
+
+            adaptor(Sink& sink, T tolerance)
+              : _sink(sink), _tolerance(tolerance), _prev()
+            {}
+
+            void operator()(move_to_t, point_t const& pt)
+            {
+                _sink(command::move_to, pt);
+                _prev = pt;
+            }
+
+            void operator()(line_to_t, point_t const& pt)
+            {
+                _sink(command::line_to, pt);
+                _prev = pt;
+            }
+
+            void operator()(quad_to_t, point_t const& pt1, point_t const& pt2)
+            {
+                unsigned n = bezier::quad_segments(_prev, pt1, pt2, _tolerance);
+                for (unsigned i = 1; i != n; ++i)
+                {
+                    T t = T(i) / n;
+                    _sink(command::line_to, point_t(
+                        bezier::quad_eval(_prev.x, pt1.x, pt2.x, t),
+                        bezier::quad_eval(_prev.y, pt1.y, pt2.y, t)));
+                }
+                _sink(command::line_to, pt2);
+                _prev = pt2;
+            }
+
+            void operator()(cubic_to_t, point_t const& pt1, point_t const& pt2, point_t const& pt3)
+            {
+                unsigned n = bezier::cubic_segments(_prev, pt1, pt2, pt3, _tolerance);
+                for (unsigned i = 1; i != n; ++i)
+                {
+                    T t = T(i) / n;
+                    _sink(command::line_to, point_t(
+                        bezier::cubic_eval(_prev.x, pt1.x, pt2.x, pt3.x, t),
+                        bezier::cubic_eval(_prev.y, pt1.y, pt2.y, pt3.y, t)));
+                }
+                _sink(command::line_to, pt3);
+                _prev = pt3;
+            }
+
+            template<class Tag>
+            void operator()(Tag tag)
+            {
+                _sink(tag);
+            }
+
+            Sink& _sink;
+            T _tolerance;
+            point_t _prev;
+        };
+
+        template<class Path, class Sink>
+        void render(Path const& path, Sink& sink) const
+        {
+            niji::render(path, adaptor<Sink>(sink, tolerance));
+        }
+
+        template<class Path, class Sink>
+        void inverse_render(Path const& path, Sink& sink) const
+        {
+            niji::inverse_render(path, adaptor<Sink>(sink, tolerance));
+        }
+    };
+}
+
+namespace niji { namespace views
+{
+    template<class T>
+    inline flatten_view<T> flatten(just_t<T> tolerance)
+    {
+        return flatten_view<T>{tolerance};
+    }
+}}
+
+#endif
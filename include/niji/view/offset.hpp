@@ -7,6 +7,8 @@
 #ifndef NIJI_VIEW_OFFSET_HPP_INCLUDED
 #define NIJI_VIEW_OFFSET_HPP_INCLUDED
 
+#include <memory>
+#include <type_traits>
 #include <boost/assert.hpp>
 #include <niji/support/view.hpp>
 #include <niji/support/just.hpp>
@@ -15,20 +17,25 @@
 
 namespace niji
 {
-    template<class T, class Joiner>
-    struct offset_view : view<offset_view<T, Joiner>>
+    // See stroke_view for `tolerance`.
+    template<class T, class Joiner, class Alloc = std::allocator<point<T>>>
+    struct offset_view : view<offset_view<T, Joiner, Alloc>>
     {
         template<class Path>
         using point_type = point<T>;
         
         T r;
         Joiner joiner;
+        Alloc alloc;
+        T tolerance;
 
-        offset_view() : r() {}
+        offset_view() : r(), tolerance() {}
 
-        offset_view(T r, Joiner joiner)
+        offset_view(T r, Joiner joiner, Alloc const& alloc = Alloc(), T tolerance = 0)
           : r(r)
           , joiner(std::forward<Joiner>(joiner))
+          , alloc(alloc)
+          , tolerance(tolerance)
         {}
 
         template<class Sink>
@@ -42,16 +49,19 @@ namespace niji
             void operator()(line_to_t, point<T> const& pt)
             {
                 _outline.line_to(pt);
+                stream();
             }
 
             void operator()(quad_to_t, point<T> const& pt1, point<T> const& pt2)
             {
                 _outline.quad_to(pt1, pt2);
+                stream();
             }
 
             void operator()(cubic_to_t, point<T> const& pt1, point<T> const& pt2, point<T> const& pt3)
             {
                 _outline.cubic_to(pt1, pt2, pt3);
+                stream();
             }
             
             void operator()(end_closed_t)
@@ -65,8 +75,15 @@ namespace niji
                 _outline.finish(_sink, _reversed);
             }
 
+            // The outer side is streamed unless it has to be reversed.
+            void stream()
+            {
+                if (!_reversed)
+                    _outline.stream(_sink);
+            }
+
             Sink& _sink;
-            detail::offset_outline<T, Joiner> _outline;
+            detail::offset_outline<T, Joiner, false, Alloc> _outline;
             bool _reversed;
         };
         
@@ -75,7 +92,7 @@ namespace niji
         {
             using adaptor_t = adaptor<Sink>;
             if (r)
-                niji::render(path, adaptor_t{sink, {r, joiner}, false});
+                niji::render(path, adaptor_t{sink, {r, joiner, alloc, tolerance}, false});
         }
 
         template<class Path, class Sink>
@@ -83,7 +100,7 @@ namespace niji
         {
             using adaptor_t = adaptor<Sink>;
             if (r)
-                niji::render(path, adaptor_t{sink, {r, joiner, {}}, true});
+                niji::render(path, adaptor_t{sink, {r, joiner, alloc, tolerance}, true});
         }
     };
 }
@@ -96,6 +113,21 @@ namespace niji { namespace views
     {
         return {r, std::forward<Joiner>(j)};
     }
+
+    template<class T, class Joiner>
+    inline offset_view<T, Joiner>
+    offset(just_t<T> r, Joiner&& j, just_t<T> tolerance)
+    {
+        return {r, std::forward<Joiner>(j), {}, tolerance};
+    }
+
+    template<class T, class Joiner, class Alloc,
+        std::enable_if_t<!std::is_arithmetic<Alloc>::value, bool> = true>
+    inline offset_view<T, Joiner, Alloc>
+    offset(just_t<T> r, Joiner&& j, Alloc const& alloc, just_t<T> tolerance = {})
+    {
+        return {r, std::forward<Joiner>(j), alloc, tolerance};
+    }
 }}
 
 #endif
\ No newline at end of file
@@ -7,27 +7,29 @@
 #ifndef NIJI_VIEW_OUTLINE_CAP_STYLE_HPP_INCLUDED
 #define NIJI_VIEW_OUTLINE_CAP_STYLE_HPP_INCLUDED
 
+#include <memory>
 #include <functional>
 #include <niji/path.hpp>
 #include <niji/support/point.hpp>
 #include <niji/support/vector.hpp>
 #include <niji/support/bezier.hpp>
+#include <niji/view/detail/outline_ref.hpp>
 
 namespace niji { namespace detail
 {
     template<class T>
     using cap_style_fn = std::function<void(
-            path<point<T>>&, point<T> const&, vector<T> const&, bool)>;
+            outline_ref<T>&, point<T> const&, vector<T> const&, bool)>;
 }}
 
 namespace niji { namespace cap_styles
 {
     struct butt
     {
-        template<class T>
+        template<class Path, class T>
         void operator()
         (
-            path<point<T>>& path, point<T> const& pt
+            Path& path, point<T> const& pt
           , vector<T> const& normal, bool is_line
         ) const
         {
@@ -38,10 +40,10 @@ namespace niji { namespace cap_styles
 
     struct square
     {
-        template<class T>
+        template<class Path, class T>
         void operator()
         (
-            path<point<T>>& path, point<T> pt
+            Path& path, point<T> pt
           , vector<T> const& normal, bool is_line
         ) const
         {
@@ -64,10 +66,10 @@ namespace niji { namespace cap_styles
             }
         };
 
-        template<class T>
+        template<class Path, class T>
         void operator()
         (
-            path<point<T>>& path, point<T> const& pt
+            Path& path, point<T> const& pt
           , vector<T> const& normal, bool is_line
         ) const
         {
@@ -92,10 +94,56 @@ namespace niji { namespace cap_styles
 #   endif
         }
     };
+
+    // One of the above selected at runtime. Unlike niji::cap_style, it's
+    // dispatched by a switch, so the cappers can be inlined.
+    struct variant
+    {
+        enum class type : char
+        {
+            butt,
+            square,
+            round
+        };
+
+        variant(butt = {}) : _type(type::butt) {}
+
+        variant(square) : _type(type::square) {}
+
+        variant(round) : _type(type::round) {}
+
+        type which() const
+        {
+            return _type;
+        }
+
+        template<class Path, class T>
+        void operator()
+        (
+            Path& path, point<T> const& pt
+          , vector<T> const& normal, bool is_line
+        ) const
+        {
+            switch (_type)
+            {
+            case type::butt:
+                return butt{}(path, pt, normal, is_line);
+            case type::square:
+                return square{}(path, pt, normal, is_line);
+            case type::round:
+                return round{}(path, pt, normal, is_line);
+            }
+        }
+
+    private:
+
+        type _type;
+    };
 }}
 
 namespace niji
 {
+    // The capper erased, it's called with the path of any allocator.
     template<class T>
     struct cap_style : detail::cap_style_fn<T>
     {
@@ -103,6 +151,17 @@ namespace niji
         cap_style(Capper capper = {})
           : detail::cap_style_fn<T>(capper)
         {}
+
+        template<class Alloc>
+        void operator()
+        (
+            path<point<T>, Alloc>& path, point<T> const& pt
+          , vector<T> const& normal, bool is_line
+        ) const
+        {
+            detail::outline_ref<T> p(path);
+            detail::cap_style_fn<T>::operator()(p, pt, normal, is_line);
+        }
     };
 }
 
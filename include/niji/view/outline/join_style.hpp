@@ -7,6 +7,7 @@
 #ifndef NIJI_VIEW_OUTLINE_JOIN_STYLE_HPP_INCLUDED
 #define NIJI_VIEW_OUTLINE_JOIN_STYLE_HPP_INCLUDED
 
+#include <memory>
 #include <functional>
 #include <niji/path.hpp>
 #include <niji/support/point.hpp>
@@ -14,14 +15,15 @@
 #include <niji/support/constants.hpp>
 #include <niji/support/numeric.hpp>
 #include <niji/support/bezier.hpp>
+#include <niji/view/detail/outline_ref.hpp>
 
 namespace niji { namespace detail
 {
-    template<class T>
+    template<class Path, class T>
     inline
     void handle_inner_join
     (
-        path<point<T>>& inner, point<T> const& pt
+        Path& inner, point<T> const& pt
       , vector<T> const& former_normal, vector<T> const& later_normal
       , T magnitude
     )
@@ -64,7 +66,7 @@ namespace niji { namespace detail
     
     template<class T>
     using join_style_fn = std::function<void(
-            path<point<T>>&, path<point<T>>&, point<T> const&
+            outline_ref<T>&, outline_ref<T>&, point<T> const&
           , vector<T> const&, vector<T> const&, T, bool, bool, T)>;
 }}
 
@@ -72,10 +74,10 @@ namespace niji { namespace join_styles
 {
     struct bevel
     {
-        template<class T>
+        template<class Path, class T>
         void operator()
         (
-            path<point<T>>& outer, path<point<T>>& inner, point<T> const& pt
+            Path& outer, Path& inner, point<T> const& pt
           , vector<T> former_normal, vector<T> later_normal
           , T r, bool prev_is_line, bool curr_is_line, T magnitude
         ) const
@@ -97,10 +99,10 @@ namespace niji { namespace join_styles
 
     struct round
     {
-        template<class T>
+        template<class Path, class T>
         void operator()
         (
-            path<point<T>>& outer, path<point<T>>& inner, point<T> const& pt
+            Path& outer, Path& inner, point<T> const& pt
           , vector<T> former_normal, vector<T> later_normal
           , T r, bool prev_is_line, bool curr_is_line, T magnitude
         ) const
@@ -149,9 +151,10 @@ namespace niji { namespace join_styles
           : inv_limit(limit > 1? 1 / limit : 1)
         {}
 
+        template<class Path>
         void operator()
         (
-            path<point<T>>& outer, path<point<T>>& inner, point<T> const& pt
+            Path& outer, Path& inner, point<T> const& pt
           , vector<T> former_normal, vector<T> later_normal
           , T r, bool prev_is_line, bool curr_is_line, T magnitude
         ) const
@@ -216,10 +219,59 @@ namespace niji { namespace join_styles
             do_miter(true);
         }
     };
+
+    // One of the above selected at runtime. Unlike niji::join_style, it's
+    // dispatched by a switch, so the joiners can be inlined.
+    template<class T>
+    struct variant
+    {
+        enum class type : char
+        {
+            bevel,
+            round,
+            miter
+        };
+
+        variant(bevel = {}) : _type(type::bevel) {}
+
+        variant(round) : _type(type::round) {}
+
+        variant(miter<T> const& m) : _type(type::miter), _miter(m) {}
+
+        type which() const
+        {
+            return _type;
+        }
+
+        template<class Path>
+        void operator()
+        (
+            Path& outer, Path& inner, point<T> const& pt
+          , vector<T> const& former_normal, vector<T> const& later_normal
+          , T r, bool prev_is_line, bool curr_is_line, T magnitude
+        ) const
+        {
+            switch (_type)
+            {
+            case type::bevel:
+                return bevel{}(outer, inner, pt, former_normal, later_normal, r, prev_is_line, curr_is_line, magnitude);
+            case type::round:
+                return round{}(outer, inner, pt, former_normal, later_normal, r, prev_is_line, curr_is_line, magnitude);
+            case type::miter:
+                return _miter(outer, inner, pt, former_normal, later_normal, r, prev_is_line, curr_is_line, magnitude);
+            }
+        }
+
+    private:
+
+        type _type;
+        miter<T> _miter;
+    };
 }}
 
 namespace niji
 {
+    // The joiner erased, it's called with the paths of any allocator.
     template<class T>
     struct join_style : detail::join_style_fn<T>
     {
@@ -227,6 +279,18 @@ namespace niji
         join_style(Joiner joiner = {})
           : detail::join_style_fn<T>(joiner)
         {}
+
+        template<class Alloc>
+        void operator()
+        (
+            path<point<T>, Alloc>& outer, path<point<T>, Alloc>& inner, point<T> const& pt
+          , vector<T> const& former_normal, vector<T> const& later_normal
+          , T r, bool prev_is_line, bool curr_is_line, T magnitude
+        ) const
+        {
+            detail::outline_ref<T> o(outer), i(inner);
+            detail::join_style_fn<T>::operator()(o, i, pt, former_normal, later_normal, r, prev_is_line, curr_is_line, magnitude);
+        }
     };
 }
 
@@ -0,0 +1,200 @@
+/*//////////////////////////////////////////////////////////////////////////////
+    Copyright (c) 2019 Jamboree
+
+    Distributed under the Boost Software License, Version 1.0. (See accompanying
+    file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//////////////////////////////////////////////////////////////////////////////*/
+#ifndef NIJI_VIEW_SIMPLIFY_HPP_INCLUDED
+#define NIJI_VIEW_SIMPLIFY_HPP_INCLUDED
+
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <niji/support/view.hpp>
+#include <niji/support/just.hpp>
+#include <niji/support/command.hpp>
+#include <niji/support/point.hpp>
+#include <niji/support/vector.hpp>
+
+namespace niji { namespace detail
+{
+    // Squared distance from the point to the segment [a, b].
+    template<class T>
+    inline T simplify_distance2(point<T> const& pt, point<T> const& a, point<T> const& b)
+    {
+        vector<T> const ab(b - a), ap(pt - a);
+        T const len2 = vectors::norm_square(ab);
+        if (len2 > 0)
+        {
+            T const t = vectors::dot(ap, ab);
+            if (t >= len2)
+                return vectors::norm_square(pt - b);
+            if (t > 0)
+            {
+                T const c = vectors::cross(ab, ap);
+                return c * c / len2;
+            }
+        }
+        return vectors::norm_square(ap);
+    }
+}}
+
+namespace niji
+{
+    // Reduces the vertices of the polylines by Douglas-Peucker, the result
+    // deviates from the input by at most the tolerance.
+    //
+    // The runs of lines are simplified as they end, i.e. at the curves and
+    // the ends of the figures. The curves are passed through and their ends
+    // are kept. For the closed figures, the closing line is simplified along
+    // with the last run, and the start is kept.
+    template<class T>
+    struct simplify_view : view<simplify_view<T>>
+    {
+        template<class Path>
+        using point_type = point<T>;
+
+        T tolerance;
+
+        explicit simplify_view(T tolerance) : tolerance(tolerance) {}
+
+        template<class Sink>
+        struct adaptor
+        {
+            using point_t = point<T>;
+
+            adaptor(Sink& sink, T tolerance)
+              : _sink(sink), _tolerance2(tolerance * tolerance)
+            {}
+
+            // The points of the geometries (e.g. Boost.Geometry adaptors) are
+            // converted as they come.
+            template<class Point>
+            void operator()(move_to_t, Point const& pt)
+            {
+                _start = convert_geometry<point_t>(pt);
+                _sink(command::move_to, _start);
+                _run.clear();
+                _run.push_back(_start);
+            }
+
+            template<class Point>
+            void operator()(line_to_t, Point const& pt)
+            {
+                _run.push_back(convert_geometry<point_t>(pt));
+            }
+
+            template<class Point>
+            void operator()(quad_to_t, Point const& pt1, Point const& pt2)
+            {
+                flush(false);
+                point_t const end(convert_geometry<point_t>(pt2));
+                _sink(command::quad_to, convert_geometry<point_t>(pt1), end);
+                _run.clear();
+                _run.push_back(end);
+            }
+
+            template<class Point>
+            void operator()(cubic_to_t, Point const& pt1, Point const& pt2, Point const& pt3)
+            {
+                flush(false);
+                point_t const end(convert_geometry<point_t>(pt3));
+                _sink(command::cubic_to, convert_geometry<point_t>(pt1), convert_geometry<point_t>(pt2), end);
+                _run.clear();
+                _run.push_back(end);
+            }
+
+            template<end_tag E>
+            void operator()(end_tag_t<E> tag)
+            {
+                bool const closed = E == end_tag::closed;
+                if (closed && !_run.empty() && _run.back() != _start)
+                    _run.push_back(_start);
+                flush(closed);
+                _run.clear();
+                _sink(tag);
+            }
+
+        private:
+
+            void flush(bool closed)
+            {
+                std::size_t const n = _run.size();
+                if (n > 2)
+                    reduce(n);
+                for (std::size_t i = 1; i < n; ++i)
+                {
+                    if (n > 2 && !_keep[i])
+                        continue;
+                    // The closing line is implied.
+                    if (closed && i == n - 1)
+                        break;
+                    _sink(command::line_to, _run[i]);
+                }
+            }
+
+            // The recursion is done by an explicit stack, the long runs
+            // (e.g. GPS tracks) may be deep.
+            void reduce(std::size_t n)
+            {
+                _keep.assign(n, false);
+                _keep[0] = _keep[n - 1] = true;
+                _stack.emplace_back(0, n - 1);
+                while (!_stack.empty())
+                {
+                    auto const range = _stack.back();
+                    _stack.pop_back();
+                    point_t const& a = _run[range.first];
+                    point_t const& b = _run[range.second];
+                    T dmax = _tolerance2;
+                    std::size_t k = 0;
+                    for (std::size_t i = range.first + 1; i < range.second; ++i)
+                    {
+                        T const d = detail::simplify_distance2(_run[i], a, b);
+                        if (d > dmax)
+                        {
+                            dmax = d;
+                            k = i;
+                        }
+                    }
+                    if (k)
+                    {
+                        _keep[k] = true;
+                        _stack.emplace_back(range.first, k);
+                        _stack.emplace_back(k, range.second);
+                    }
+                }
+            }
+
+            Sink& _sink;
+            T _tolerance2;
+            point_t _start;
+            std::vector<point_t> _run;
+            std::vector<bool> _keep;
+            std::vector<std::pair<std::size_t, std::size_t>> _stack;
+        };
+
+        template<class Path, class Sink>
+        void render(Path const& path, Sink& sink) const
+        {
+            niji::render(path, adaptor<Sink>{sink, tolerance});
+        }
+
+        template<class Path, class Sink>
+        void inverse_render(Path const& path, Sink& sink) const
+        {
+            niji::inverse_render(path, adaptor<Sink>{sink, tolerance});
+        }
+    };
+}
+
+namespace niji { namespace views
+{
+    template<class T>
+    inline simplify_view<T> simplify(just_t<T> tolerance)
+    {
+        return simplify_view<T>{tolerance};
+    }
+}}
+
+#endif
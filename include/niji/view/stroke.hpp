@@ -7,17 +7,32 @@
 #ifndef NIJI_VIEW_STROKE_HPP_INCLUDED
 #define NIJI_VIEW_STROKE_HPP_INCLUDED
 
+#include <memory>
 #include <type_traits>
+#include <boost/optional/optional.hpp>
 #include <niji/support/view.hpp>
 #include <niji/support/just.hpp>
+#include <niji/support/transform/affine.hpp>
+#include <niji/support/tolerance.hpp>
+#include <niji/view/transform.hpp>
 #include <niji/view/detail/stroker.hpp>
 #include <niji/view/outline/join_style.hpp>
 #include <niji/view/outline/cap_style.hpp>
 
 namespace niji
 {
-    template<class T, class Joiner = join_style<T>, class Capper = cap_style<T>>
-    struct stroke_view : view<stroke_view<T, Joiner, Capper>>
+    // Alloc is used for the scratch paths, e.g. a pmr allocator backed by
+    // a pool resource makes the stroking free of heap allocations once warmed.
+    // If `tolerance` is positive, the subdivision of curves is limited by it
+    // instead of the fixed depths, see bezier::subdivide_depth.
+    //
+    // If `matrix` is set, the output is in its device space and so is the
+    // tolerance, NIJI_DEVICE_TOLERANCE by default, i.e. the subdivision
+    // follows the device size. The pen is still in the user space, its outline
+    // is mapped as it's streamed, no second pass is needed. A pen of r == 0 is
+    // a hairline, stroked in the device space 1 unit wide, whatever the matrix.
+    template<class T, class Joiner = join_style<T>, class Capper = cap_style<T>, class Alloc = std::allocator<point<T>>>
+    struct stroke_view : view<stroke_view<T, Joiner, Capper, Alloc>>
     {
         template<class Path>
         using point_type = point<T>;
@@ -25,13 +40,18 @@ namespace niji
         T r;
         Joiner joiner;
         Capper capper;
+        Alloc alloc;
+        T tolerance;
+        boost::optional<transforms::affine<T>> matrix;
         
-        stroke_view() : r() {}
+        stroke_view() : r(), tolerance() {}
 
-        stroke_view(T r, Joiner joiner, Capper capper)
+        stroke_view(T r, Joiner joiner, Capper capper, Alloc const& alloc = Alloc(), T tolerance = 0)
           : r(r)
           , joiner(std::forward<Joiner>(joiner))
           , capper(std::forward<Capper>(capper))
+          , alloc(alloc)
+          , tolerance(tolerance)
         {}
 
         template<class Sink>
@@ -39,55 +59,111 @@ namespace niji
         {
             void operator()(move_to_t, point<T> const& pt)
             {
-                _stroker.move_to(pt);
+                _stroker.move_to(map(pt));
             }
 
             void operator()(line_to_t, point<T> const& pt)
             {
-                _stroker.line_to(pt);
+                _stroker.line_to(map(pt));
+                stream();
             }
 
             void operator()(quad_to_t, point<T> const& pt1, point<T> const& pt2)
             {
-                _stroker.quad_to(pt1, pt2);
+                _stroker.quad_to(map(pt1), map(pt2));
+                stream();
             }
 
             void operator()(cubic_to_t, point<T> const& pt1, point<T> const& pt2, point<T> const& pt3)
             {
-                _stroker.cubic_to(pt1, pt2, pt3);
+                _stroker.cubic_to(map(pt1), map(pt2), map(pt3));
+                stream();
             }
             
             void operator()(end_closed_t)
             {
                 _stroker.close(true); // TODO
-                _stroker.finish(_sink, _reversed);
+                finish();
             }
             
             void operator()(end_open_t)
             {
                 _stroker.cut(true); // TODO
-                _stroker.finish(_sink, _reversed);
+                finish();
+            }
+
+            // The outer side is streamed unless it has to be reversed.
+            void stream()
+            {
+                if (!_reversed)
+                    with_sink([this](auto& sink) { _stroker.stream(sink); });
+            }
+
+            void finish()
+            {
+                with_sink([this](auto& sink) { _stroker.finish(sink, _reversed); });
+            }
+
+            // The hairlines are stroked in the device space.
+            point<T> map(point<T> const& pt) const
+            {
+                return _input ? (*_input)(pt) : pt;
+            }
+
+            template<class F>
+            void with_sink(F&& f)
+            {
+                if (_matrix)
+                {
+                    typename transform_view<transforms::affine<T>>::template adaptor<Sink> sink{_sink, *_matrix};
+                    f(sink);
+                }
+                else
+                    f(_sink);
             }
 
             Sink& _sink;
-            detail::stroker<T, std::decay_t<Joiner>, std::decay_t<Capper>> _stroker;
+            detail::stroker<T, std::decay_t<Joiner>, std::decay_t<Capper>, Alloc> _stroker;
             bool _reversed;
+            transforms::affine<T> const* _matrix;
+            transforms::affine<T> const* _input;
         };
         
         template<class Path, class Sink>
         void render(Path const& path, Sink& sink) const
         {
-            using adaptor_t = adaptor<Sink>;
-            if (r)
-                niji::render(path, adaptor_t{sink, {r, joiner, capper}, false});
+            render_impl(path, sink, false);
         }
 
         template<class Path, class Sink>
         void inverse_render(Path const& path, Sink& sink) const
+        {
+            render_impl(path, sink, true);
+        }
+
+        T device_tolerance() const
+        {
+            return tolerance > 0 ? tolerance : T(NIJI_DEVICE_TOLERANCE);
+        }
+
+        T user_tolerance() const
+        {
+            if (!matrix)
+                return tolerance;
+            T s = matrix->max_scale();
+            return s ? device_tolerance() / s : T(0);
+        }
+
+    private:
+
+        template<class Path, class Sink>
+        void render_impl(Path const& path, Sink& sink, bool reversed) const
         {
             using adaptor_t = adaptor<Sink>;
             if (r)
-                niji::render(path, adaptor_t{sink, {r, joiner, capper}, true});
+                niji::render(path, adaptor_t{sink, {r, joiner, capper, alloc, user_tolerance()}, reversed, matrix.get_ptr(), nullptr});
+            else if (matrix)
+                niji::render(path, adaptor_t{sink, {T(0.5), joiner, capper, alloc, device_tolerance()}, reversed, nullptr, matrix.get_ptr()});
         }
     };
 }
@@ -100,6 +176,42 @@ namespace niji { namespace views
     {
         return {r, std::forward<Joiner>(j), std::forward<Capper>(c)};
     }
+
+    template<class T, class Joiner, class Capper>
+    inline stroke_view<T, Joiner, Capper>
+    stroke(just_t<T> r, Joiner&& j, Capper&& c, just_t<T> tolerance)
+    {
+        return {r, std::forward<Joiner>(j), std::forward<Capper>(c), {}, tolerance};
+    }
+
+    template<class T, class Joiner, class Capper, class Alloc,
+        std::enable_if_t<!std::is_arithmetic<Alloc>::value &&
+            !std::is_same<Alloc, transforms::affine<T>>::value, bool> = true>
+    inline stroke_view<T, Joiner, Capper, Alloc>
+    stroke(just_t<T> r, Joiner&& j, Capper&& c, Alloc const& alloc, just_t<T> tolerance = {})
+    {
+        return {r, std::forward<Joiner>(j), std::forward<Capper>(c), alloc, tolerance};
+    }
+
+    // Strokes with the pen in the user space, the output is in the device
+    // space of the matrix.
+    template<class T, class Joiner, class Capper>
+    inline stroke_view<T, Joiner, Capper>
+    stroke(just_t<T> r, Joiner&& j, Capper&& c, transforms::affine<T> const& matrix, just_t<T> tolerance = {})
+    {
+        stroke_view<T, Joiner, Capper> ret{r, std::forward<Joiner>(j), std::forward<Capper>(c), {}, tolerance};
+        ret.matrix = matrix;
+        return ret;
+    }
+
+    template<class T, class Joiner, class Capper, class Alloc>
+    inline stroke_view<T, Joiner, Capper, Alloc>
+    stroke(just_t<T> r, Joiner&& j, Capper&& c, Alloc const& alloc, transforms::affine<T> const& matrix, just_t<T> tolerance = {})
+    {
+        stroke_view<T, Joiner, Capper, Alloc> ret{r, std::forward<Joiner>(j), std::forward<Capper>(c), alloc, tolerance};
+        ret.matrix = matrix;
+        return ret;
+    }
 }}
 
 #endif
\ No newline at end of file
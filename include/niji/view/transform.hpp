@@ -9,6 +9,7 @@
 
 #include <type_traits>
 #include <niji/support/view.hpp>
+#include <niji/support/batch.hpp>
 
 namespace niji
 {
@@ -43,6 +44,24 @@ namespace niji
             niji::render(path, adaptor<Sink>{sink, *this});
         }
 
+        // Fast paths for transforms that work in bulk, e.g. transforms::affine.
+        template<class Node, class Alloc, class Sink>
+        auto render(flat_path<Node, Alloc> const& path, Sink& sink) const ->
+            decltype(path.render_transformed(sink, std::declval<F const&>()))
+        {
+            path.render_transformed(sink, static_cast<F const&>(*this));
+        }
+
+        // For niji::path, only when the sink accepts batches, otherwise
+        // mapping the points on the way is faster.
+        template<class Node, class Alloc, class Sink>
+        auto render(path<Node, Alloc> const& path, Sink& sink) const ->
+            std::enable_if_t<detail::is_batch_sink<Sink, decltype(std::declval<F const&>()(std::declval<Node const&>()))>::value,
+                decltype(path.render_transformed(sink, std::declval<F const&>()))>
+        {
+            path.render_transformed(sink, static_cast<F const&>(*this));
+        }
+
         template<class Path, class Sink>
         void inverse_render(Path const& path, Sink& sink) const
         {